@@ -0,0 +1,161 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Micro-benchmark for bd_rle_decode_argb() / bd_rle_decode_yuva().
+ *
+ * Decodes synthetic subtitle-like image (transparent plane with
+ * text lines at the bottom) repeatedly and prints decoding speed.
+ */
+
+#include "decoders/overlay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static BD_PG_RLE_ELEM *_make_image(unsigned w, unsigned h, unsigned *num_elem)
+{
+    BD_PG_RLE_ELEM *img = calloc((size_t)w * h + h, sizeof(*img));
+    unsigned x, y, n = 0, seed = 1;
+
+    if (!img) {
+        return NULL;
+    }
+
+    for (y = 0; y < h; y++) {
+        if (y < h * 3 / 4) {
+            /* transparent line */
+            img[n].len   = w;
+            img[n].color = 0xff;
+            n++;
+        } else {
+            /* "text": short runs of outline / fill colors */
+            for (x = 0; x < w; ) {
+                unsigned len;
+
+                seed = seed * 1103515245 + 12345;
+                len  = 1 + ((seed >> 16) % 12);
+                if (len > w - x) {
+                    len = w - x;
+                }
+                img[n].len   = len;
+                img[n].color = (seed >> 8) & 3 ? (seed >> 12) & 3 : 0xff;
+                n++;
+                x += len;
+            }
+        }
+        /* end of line */
+        img[n].len   = 0;
+        img[n].color = 0;
+        n++;
+    }
+
+    *num_elem = n;
+    return img;
+}
+
+static void _make_palette(BD_PG_PALETTE_ENTRY *pal)
+{
+    unsigned ii;
+
+    for (ii = 0; ii < 256; ii++) {
+        pal[ii].Y  = 16 + ii * 219 / 255;
+        pal[ii].Cr = 128;
+        pal[ii].Cb = 128;
+        pal[ii].T  = ii == 0xff ? 0 : 255;
+    }
+}
+
+static double _run(const BD_OVERLAY *ov, uint32_t *buf, unsigned iterations, int yuva, unsigned flags)
+{
+    clock_t start = clock();
+    unsigned ii;
+
+    for (ii = 0; ii < iterations; ii++) {
+        int r = yuva ? bd_rle_decode_yuva(ov, buf, ov->w, 0, 0, ov->w, ov->h)
+                     : bd_rle_decode_argb(ov, buf, ov->w, 0, 0, ov->w, ov->h, flags);
+        if (r < 0) {
+            fprintf(stderr, "decoding failed\n");
+            exit(1);
+        }
+    }
+
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void _print(const char *name, const BD_OVERLAY *ov, unsigned iterations, double t)
+{
+    printf("%-20s %8.3f ms/frame %10.1f Mpixel/s\n", name,
+           t * 1000.0 / iterations,
+           t > 0 ? (double)ov->w * ov->h * iterations / t / 1e6 : 0.0);
+}
+
+int main(int argc, char *argv[])
+{
+    BD_PG_PALETTE_ENTRY pal[256];
+    BD_PG_RLE_ELEM *img;
+    BD_OVERLAY ov;
+    uint32_t  *buf;
+    unsigned   w = 1920, h = 1080, iterations = 200, num_elem = 0;
+
+    if (argc > 1 && (argc < 3 || argc > 4)) {
+        fprintf(stderr, "usage: %s [<width> <height> [<iterations>]]\n", argv[0]);
+        return 1;
+    }
+    if (argc > 2) {
+        w = (unsigned)atoi(argv[1]);
+        h = (unsigned)atoi(argv[2]);
+    }
+    if (argc > 3) {
+        iterations = (unsigned)atoi(argv[3]);
+    }
+    if (w < 1 || w > 0xffff || h < 1 || h > 0xffff || iterations < 1) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    img = _make_image(w, h, &num_elem);
+    buf = malloc((size_t)w * h * sizeof(uint32_t));
+    if (!img || !buf) {
+        fprintf(stderr, "out of memory\n");
+        free(img);
+        free(buf);
+        return 1;
+    }
+    _make_palette(pal);
+
+    memset(&ov, 0, sizeof(ov));
+    ov.cmd     = BD_OVERLAY_DRAW;
+    ov.w       = w;
+    ov.h       = h;
+    ov.palette = pal;
+    ov.img     = img;
+
+    printf("%ux%u, %u RLE elements, %u iterations\n", w, h, num_elem, iterations);
+
+    _print("argb",               &ov, iterations, _run(&ov, buf, iterations, 0, 0));
+    _print("argb premultiplied", &ov, iterations, _run(&ov, buf, iterations, 0, BD_RLE_DECODE_PREMULTIPLIED));
+    _print("yuva",               &ov, iterations, _run(&ov, buf, iterations, 1, 0));
+
+    free(img);
+    free(buf);
+    return 0;
+}
@@ -28,6 +28,7 @@
 #include "util/strutl.h"
 
 #include <stdio.h>  // SEEK_*
+#include <stdlib.h>
 #include <string.h> // strchr
 
 
@@ -45,6 +46,42 @@ int64_t file_size(BD_FILE_H *fp)
     return length;
 }
 
+int64_t file_read_at(BD_FILE_EXT *fp, uint8_t *buf, size_t size, int64_t offset)
+{
+    if (fp->read_at) {
+        return fp->read_at(&fp->file, buf, (int64_t)size, offset);
+    }
+
+    if (file_seek(&fp->file, offset, SEEK_SET) != offset) {
+        return -1;
+    }
+    return (int64_t)file_read(&fp->file, buf, size);
+}
+
+size_t file_read_all(BD_FILE_H *fp, uint8_t **data)
+{
+    int64_t size;
+
+    *data = NULL;
+
+    size = file_size(fp);
+    if (size <= 0 || size >= BD_MAX_SSIZE) {
+        return 0;
+    }
+
+    *data = malloc((size_t)size);
+    if (!*data) {
+        return 0;
+    }
+
+    if (file_read(fp, *data, (size_t)size) != (size_t)size) {
+        X_FREE(*data);
+        return 0;
+    }
+
+    return (size_t)size;
+}
+
 int file_mkdirs(const char *path)
 {
     int result = 0;
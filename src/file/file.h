@@ -63,12 +63,52 @@ static inline BD_USED size_t file_read(BD_FILE_H *fp, uint8_t *buf, size_t size)
     return (size_t)fp->read(fp, buf, (int64_t)size);
 }
 
+/*
+ * Files created by libbluray file implementations (file_open_default(),
+ * file_open_mmap(), file_open_uring()) are allocated as BD_FILE_EXT.
+ * Application-provided BD_FILE_H objects are not: use only BD_FILE_EXT
+ * pointers returned by file_open_ext().
+ */
+
+typedef struct {
+    BD_FILE_H  file;   /* must be first */
+
+    /* optional positional read. Does not use or change current file offset.
+     * Must be safe to call from multiple threads simultaneously. */
+    int64_t  (*read_at)(BD_FILE_H *file, uint8_t *buf, int64_t size, int64_t offset);
+} BD_FILE_EXT;
+
+/* open local file for reading with libbluray file implementation, even if
+ * file_open() has been replaced. Uses memory-mapped I/O if requested and supported. */
+BD_PRIVATE BD_FILE_EXT *file_open_ext(const char *filename, int use_mmap);
+
+/* positional read. Without read_at this falls back to seek + read (not atomic). */
+BD_PRIVATE BD_USED int64_t file_read_at(BD_FILE_EXT *fp, uint8_t *buf, size_t size, int64_t offset);
+
 BD_PRIVATE int64_t file_size(BD_FILE_H *fp);
 
+/* read whole file to allocated buffer. Returns file size, or 0 on error. */
+BD_PRIVATE size_t file_read_all(BD_FILE_H *fp, uint8_t **data);
+
 BD_PRIVATE extern BD_FILE_H *(*file_open)(const char* filename, const char *mode);
 
 BD_PRIVATE BD_FILE_OPEN file_open_default(void);
 
+/* open local file for reading using memory-mapped I/O.
+ * Returns NULL if not supported (caller should fall back to file_open()). */
+BD_PRIVATE BD_FILE_H *file_open_mmap(const char *filename);
+
+/* hint OS to start caching part of local file.
+ * No-op if not supported or if file_open() has been replaced. */
+BD_PRIVATE void file_prefetch(const char *filename, int64_t offset, int64_t size);
+
+
+#ifdef HAVE_LIBURING
+/* open local file for sequential reading with asynchronous read-ahead (io_uring).
+ * Returns NULL if io_uring is not available (caller should fall back to file_open()). */
+BD_PRIVATE BD_FILE_H *file_open_uring(const char *filename, unsigned num_units);
+#endif
+
 
 /*
  * directory access
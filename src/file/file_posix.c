@@ -38,9 +38,21 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#if defined(__linux__)
+#include <sys/vfs.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__DragonFly__)
+#include <sys/param.h>
+#include <sys/mount.h>
+#endif
+#endif
+
 #ifdef __ANDROID__
 # undef  lseek
 # define lseek lseek64
+# undef  pread
+# define pread pread64
 # undef  off_t
 # define off_t off64_t
 #endif
@@ -105,6 +117,31 @@ static int64_t _file_read(BD_FILE_H *file, uint8_t *buf, int64_t size)
     return (int64_t)got;
 }
 
+static int64_t _file_read_at(BD_FILE_H *file, uint8_t *buf, int64_t size, int64_t offset)
+{
+    ssize_t got, result;
+
+    if (size <= 0 || size >= BD_MAX_SSIZE || offset < 0) {
+        BD_DEBUG(DBG_FILE | DBG_CRIT, "Ignoring invalid read of size %" PRId64 " at %" PRId64 " (%p)\n", size, offset, (void*)file);
+        return 0;
+    }
+
+    for (got = 0; got < (ssize_t)size; got += result) {
+        result = pread((int)(intptr_t)file->internal, buf + got, size - got, (off_t)(offset + got));
+        if (result < 0) {
+            if (errno != EINTR) {
+                BD_DEBUG(DBG_FILE, "pread() failed (%p)\n", (void*)file);
+                break;
+            }
+            result = 0;
+        } else if (result == 0) {
+            // hit EOF.
+            break;
+        }
+    }
+    return (int64_t)got;
+}
+
 static int64_t _file_write(BD_FILE_H *file, const uint8_t *buf, int64_t size)
 {
     ssize_t written, result;
@@ -136,6 +173,7 @@ static int64_t _file_write(BD_FILE_H *file, const uint8_t *buf, int64_t size)
 
 static BD_FILE_H *_file_open(const char* filename, const char *cmode)
 {
+    BD_FILE_EXT *ext;
     BD_FILE_H *file;
     int fd    = -1;
     int flags = 0;
@@ -160,13 +198,16 @@ static BD_FILE_H *_file_open(const char* filename, const char *cmode)
         return NULL;
     }
 
-    file = calloc(1, sizeof(BD_FILE_H));
-    if (!file) {
+    ext = calloc(1, sizeof(BD_FILE_EXT));
+    if (!ext) {
         close(fd);
         BD_DEBUG(DBG_FILE, "Error opening file %s (out of memory)\n", filename);
         return NULL;
     }
 
+    ext->read_at = _file_read_at;
+
+    file = &ext->file;
     file->close = _file_close;
     file->seek  = _file_seek;
     file->read  = _file_read;
@@ -182,6 +223,306 @@ static BD_FILE_H *_file_open(const char* filename, const char *cmode)
 
 BD_FILE_H* (*file_open)(const char* filename, const char *mode) = _file_open;
 
+/*
+ * memory-mapped read-only file
+ */
+
+#if defined(HAVE_SYS_MMAN_H) && defined(MAP_FAILED)
+
+#define MMAP_WINDOW (8 * 1024 * 1024)  /* read-ahead hint window */
+
+typedef struct {
+    uint8_t *map;
+    int64_t  size;
+    int64_t  pos;
+    int64_t  advise_start;  /* current read-ahead window */
+    int64_t  advise_end;
+    int64_t  page_mask;
+} MMAP_FILE;
+
+static void _mmap_advise(MMAP_FILE *mf)
+{
+    /* move read-ahead window when reading position gets close to the end of it */
+    if (mf->pos < mf->advise_start || mf->pos + MMAP_WINDOW / 2 > mf->advise_end) {
+        int64_t start = mf->pos & mf->page_mask;
+        int64_t end   = BD_MIN(start + MMAP_WINDOW, mf->size);
+        if (start < end) {
+#ifdef MADV_WILLNEED
+            madvise(mf->map + start, (size_t)(end - start), MADV_WILLNEED);
+#endif
+        }
+        mf->advise_start = start;
+        mf->advise_end   = end;
+    }
+}
+
+static void _mmap_close(BD_FILE_H *file)
+{
+    if (file) {
+        MMAP_FILE *mf = (MMAP_FILE *)file->internal;
+
+        if (munmap(mf->map, (size_t)mf->size)) {
+            BD_DEBUG(DBG_CRIT | DBG_FILE, "Error unmapping file (%p)\n", (void*)file);
+        }
+
+        BD_DEBUG(DBG_FILE, "Closed mapped file (%p)\n", (void*)file);
+
+        X_FREE(file->internal);
+        X_FREE(file);
+    }
+}
+
+static int64_t _mmap_seek(BD_FILE_H *file, int64_t offset, int32_t origin)
+{
+    MMAP_FILE *mf = (MMAP_FILE *)file->internal;
+
+    switch (origin) {
+        case SEEK_CUR: offset += mf->pos;  break;
+        case SEEK_END: offset += mf->size; break;
+        case SEEK_SET: break;
+        default:
+            return -1;
+    }
+
+    if (offset < 0) {
+        BD_DEBUG(DBG_FILE, "seek to negative offset (%p)\n", (void*)file);
+        return -1;
+    }
+
+    mf->pos = offset;
+    return offset;
+}
+
+static int64_t _mmap_tell(BD_FILE_H *file)
+{
+    MMAP_FILE *mf = (MMAP_FILE *)file->internal;
+    return mf->pos;
+}
+
+static int64_t _mmap_read(BD_FILE_H *file, uint8_t *buf, int64_t size)
+{
+    MMAP_FILE *mf = (MMAP_FILE *)file->internal;
+
+    if (size <= 0 || size >= BD_MAX_SSIZE) {
+        BD_DEBUG(DBG_FILE | DBG_CRIT, "Ignoring invalid read of size %" PRId64 " (%p)\n", size, (void*)file);
+        return 0;
+    }
+
+    if (mf->pos >= mf->size) {
+        return 0;
+    }
+
+    size = BD_MIN(size, mf->size - mf->pos);
+    memcpy(buf, mf->map + mf->pos, (size_t)size);
+    mf->pos += size;
+
+    _mmap_advise(mf);
+
+    return size;
+}
+
+static int64_t _mmap_read_at(BD_FILE_H *file, uint8_t *buf, int64_t size, int64_t offset)
+{
+    MMAP_FILE *mf = (MMAP_FILE *)file->internal;
+
+    if (size <= 0 || size >= BD_MAX_SSIZE || offset < 0) {
+        BD_DEBUG(DBG_FILE | DBG_CRIT, "Ignoring invalid read of size %" PRId64 " at %" PRId64 " (%p)\n", size, offset, (void*)file);
+        return 0;
+    }
+
+    if (offset >= mf->size) {
+        return 0;
+    }
+
+    size = BD_MIN(size, mf->size - offset);
+    memcpy(buf, mf->map + offset, (size_t)size);
+
+    /* no shared state here: request next window when crossing window boundary */
+#ifdef MADV_WILLNEED
+    if (offset / MMAP_WINDOW != (offset + size) / MMAP_WINDOW) {
+        int64_t start = ((offset + size) / MMAP_WINDOW) * MMAP_WINDOW;
+        int64_t end   = BD_MIN(start + MMAP_WINDOW, mf->size);
+        if (start < end) {
+            madvise(mf->map + start, (size_t)(end - start), MADV_WILLNEED);
+        }
+    }
+#endif
+
+    return size;
+}
+
+/* I/O error in mapped file raises SIGBUS instead of failing read.
+ * Map only files in local (non-network, non-optical) file systems. */
+static int _mmap_fs_ok(int fd)
+{
+#if defined(__linux__)
+    struct statfs sfs;
+    if (fstatfs(fd, &sfs) < 0) {
+        return 0;
+    }
+    switch ((uint32_t)sfs.f_type) {
+        case 0x6969:      /* NFS */
+        case 0x517b:      /* SMB */
+        case 0xff534d42:  /* CIFS */
+        case 0xfe534d42:  /* SMB2 */
+        case 0x01021997:  /* 9P */
+        case 0x00c36400:  /* CEPH */
+        case 0x5346414f:  /* AFS */
+        case 0x73757245:  /* CODA */
+        case 0x65735546:  /* FUSE */
+        case 0x9660:      /* ISO9660 */
+        case 0x15013346:  /* UDF */
+            return 0;
+    }
+    return 1;
+#elif defined(MNT_LOCAL)
+    struct statfs sfs;
+    return fstatfs(fd, &sfs) == 0 && (sfs.f_flags & MNT_LOCAL);
+#else
+    (void)fd;
+    return 1;
+#endif
+}
+
+BD_FILE_H *file_open_mmap(const char *filename)
+{
+    BD_FILE_EXT *ext;
+    BD_FILE_H  *file;
+    MMAP_FILE  *mf;
+    struct stat st;
+    void       *map;
+    long        page_size;
+    int         fd;
+    int         flags = O_RDONLY;
+
+    /* custom file system in use ? */
+    if (file_open != _file_open) {
+        return NULL;
+    }
+
+    /* whole file is mapped. Don't exhaust address space in 32-bit systems. */
+    if (sizeof(void *) < 8) {
+        return NULL;
+    }
+
+#ifdef O_CLOEXEC
+    flags |= O_CLOEXEC;
+#endif
+
+    if ((fd = open(filename, flags)) < 0) {
+        BD_DEBUG(DBG_FILE, "Error opening file %s\n", filename);
+        return NULL;
+    }
+
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+
+    if (!_mmap_fs_ok(fd)) {
+        BD_DEBUG(DBG_FILE, "Not mapping %s (network or removable file system)\n", filename);
+        close(fd);
+        return NULL;
+    }
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        BD_DEBUG(DBG_FILE, "Error mapping file %s\n", filename);
+        return NULL;
+    }
+
+#ifdef MADV_SEQUENTIAL
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+
+    ext = calloc(1, sizeof(BD_FILE_EXT));
+    mf  = calloc(1, sizeof(MMAP_FILE));
+    if (!ext || !mf) {
+        munmap(map, (size_t)st.st_size);
+        X_FREE(ext);
+        X_FREE(mf);
+        BD_DEBUG(DBG_FILE, "Error opening file %s (out of memory)\n", filename);
+        return NULL;
+    }
+
+    page_size = sysconf(_SC_PAGESIZE);
+
+    mf->map          = (uint8_t *)map;
+    mf->size         = (int64_t)st.st_size;
+    mf->page_mask    = ~(int64_t)((page_size > 0 ? page_size : 4096) - 1);
+    mf->advise_start = -1;
+
+    ext->read_at = _mmap_read_at;
+
+    file = &ext->file;
+    file->close = _mmap_close;
+    file->seek  = _mmap_seek;
+    file->read  = _mmap_read;
+    file->tell  = _mmap_tell;
+
+    file->internal = mf;
+
+    BD_DEBUG(DBG_FILE, "Opened mapped file %s (%p)\n", filename, (void*)file);
+    return file;
+}
+
+#else
+
+BD_FILE_H *file_open_mmap(const char *filename)
+{
+    (void)filename;
+    return NULL;
+}
+
+#endif
+
+void file_prefetch(const char *filename, int64_t offset, int64_t size)
+{
+#ifdef POSIX_FADV_WILLNEED
+    int fd;
+    int flags = O_RDONLY;
+
+    /* application-provided file access, file may not be local */
+    if (file_open != _file_open) {
+        return;
+    }
+
+#ifdef O_CLOEXEC
+    flags |= O_CLOEXEC;
+#endif
+
+    if ((fd = open(filename, flags)) < 0) {
+        return;
+    }
+
+    if (posix_fadvise(fd, (off_t)offset, (off_t)size, POSIX_FADV_WILLNEED)) {
+        BD_DEBUG(DBG_FILE, "posix_fadvise(%s) failed\n", filename);
+    }
+
+    close(fd);
+#else
+    (void)filename;
+    (void)offset;
+    (void)size;
+#endif
+}
+
+BD_FILE_EXT *file_open_ext(const char *filename, int use_mmap)
+{
+    BD_FILE_H *fp = NULL;
+
+    if (use_mmap) {
+        fp = file_open_mmap(filename);
+    }
+    if (!fp) {
+        fp = _file_open(filename, "rb");
+    }
+
+    /* both implementations allocate BD_FILE_EXT */
+    return (BD_FILE_EXT *)fp;
+}
+
 BD_FILE_OPEN file_open_default(void)
 {
     return _file_open;
@@ -0,0 +1,435 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Read-only file with asynchronous sequential read-ahead using io_uring.
+ *
+ * Several reads are kept queued ahead of current file position.
+ * Caller can process previous data while kernel fills the buffers.
+ * Completions are reaped from calling thread; no extra threads are used.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "file.h"
+#include "util/macro.h"
+#include "util/logging.h"
+
+#include <liburing.h>
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h> // SEEK_*
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#define URING_BUF_SIZE  (32 * 6144)  /* size of single queued read */
+#define URING_MIN_BUFS  2
+
+typedef struct {
+    int64_t  offset;   /* file offset of buffer data */
+    int64_t  result;   /* bytes read, < 0 on error */
+    int      pending;  /* read queued, not yet completed */
+    int      valid;    /* slot is in use (pending or completed) */
+} URING_SLOT;
+
+typedef struct {
+    int             fd;
+    struct io_uring ring;
+
+    int64_t   size;        /* file size */
+    int64_t   pos;         /* current (logical) file position */
+    int64_t   next_offset; /* file offset of next queued read */
+
+    unsigned  num_bufs;
+    unsigned  head;        /* slot holding data at pos */
+    unsigned  num_pending;
+    uint8_t   failed;      /* submitting failed, use synchronous reads */
+    uint8_t  *bufs;
+    URING_SLOT *slots;
+} URING_FILE;
+
+/*
+ * queue handling
+ */
+
+static int _submit_slot(URING_FILE *uf, unsigned idx)
+{
+    URING_SLOT *s = &uf->slots[idx];
+    struct io_uring_sqe *sqe;
+
+    if (uf->next_offset >= uf->size) {
+        s->valid = 0;
+        return 0;
+    }
+
+    sqe = io_uring_get_sqe(&uf->ring);
+    if (!sqe) {
+        s->valid = 0;
+        return -1;
+    }
+
+    io_uring_prep_read(sqe, uf->fd, uf->bufs + (size_t)idx * URING_BUF_SIZE,
+                       URING_BUF_SIZE, (uint64_t)uf->next_offset);
+    io_uring_sqe_set_data(sqe, (void *)(uintptr_t)idx);
+
+    s->offset  = uf->next_offset;
+    s->result  = 0;
+    s->pending = 1;
+    s->valid   = 1;
+
+    uf->next_offset += URING_BUF_SIZE;
+    uf->num_pending++;
+
+    return 1;
+}
+
+static int _reap_one(URING_FILE *uf)
+{
+    struct io_uring_cqe *cqe;
+    unsigned idx;
+    int      ret;
+
+    do {
+        ret = io_uring_wait_cqe(&uf->ring, &cqe);
+    } while (ret == -EINTR);
+
+    if (ret < 0) {
+        BD_DEBUG(DBG_FILE | DBG_CRIT, "io_uring_wait_cqe() failed: %d\n", ret);
+        return -1;
+    }
+
+    idx = (unsigned)(uintptr_t)io_uring_cqe_get_data(cqe);
+    if (idx < uf->num_bufs && uf->slots[idx].pending) {
+        uf->slots[idx].result  = cqe->res;
+        uf->slots[idx].pending = 0;
+        uf->num_pending--;
+    }
+    io_uring_cqe_seen(&uf->ring, cqe);
+
+    return 0;
+}
+
+/* submit queued reads */
+static int _submit(URING_FILE *uf)
+{
+    int ret = io_uring_submit(&uf->ring);
+
+    /* reads left in submission queue would never complete */
+    if (ret < 0 || io_uring_sq_ready(&uf->ring) > 0) {
+        BD_DEBUG(DBG_FILE | DBG_CRIT, "io_uring_submit() failed: %d\n", ret);
+        uf->failed = 1;
+        return -1;
+    }
+
+    return 0;
+}
+
+/* wait until kernel is done with all buffers */
+static void _drain(URING_FILE *uf)
+{
+    /* reads that were not submitted are never completed */
+    unsigned unsubmitted = io_uring_sq_ready(&uf->ring);
+    unsigned ii;
+
+    while (uf->num_pending > unsubmitted) {
+        if (_reap_one(uf) < 0) {
+            break;
+        }
+    }
+
+    for (ii = 0; ii < uf->num_bufs; ii++) {
+        uf->slots[ii].valid = 0;
+    }
+}
+
+/* (re-)start queued reads from current position */
+static int _restart(URING_FILE *uf)
+{
+    unsigned ii;
+
+    _drain(uf);
+    if (uf->num_pending > 0) {
+        /* ring is broken, buffers can't be re-used */
+        uf->failed = 1;
+        return -1;
+    }
+
+    uf->head        = 0;
+    uf->next_offset = uf->pos;
+
+    for (ii = 0; ii < uf->num_bufs; ii++) {
+        if (_submit_slot(uf, ii) <= 0) {
+            break;
+        }
+    }
+
+    if (_submit(uf) < 0) {
+        _drain(uf);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * BD_FILE_H
+ */
+
+static void _file_close(BD_FILE_H *file)
+{
+    if (file) {
+        URING_FILE *uf = (URING_FILE *)file->internal;
+
+        _drain(uf);
+        io_uring_queue_exit(&uf->ring);
+
+        if (close(uf->fd)) {
+            BD_DEBUG(DBG_CRIT | DBG_FILE, "Error closing io_uring file (%p)\n", (void*)file);
+        }
+
+        BD_DEBUG(DBG_FILE, "Closed io_uring file (%p)\n", (void*)file);
+
+        X_FREE(uf->bufs);
+        X_FREE(uf->slots);
+        X_FREE(file->internal);
+        X_FREE(file);
+    }
+}
+
+static int64_t _file_seek(BD_FILE_H *file, int64_t offset, int32_t origin)
+{
+    URING_FILE *uf = (URING_FILE *)file->internal;
+
+    switch (origin) {
+        case SEEK_CUR: offset += uf->pos;  break;
+        case SEEK_END: offset += uf->size; break;
+        case SEEK_SET: break;
+        default:
+            return -1;
+    }
+
+    if (offset < 0) {
+        BD_DEBUG(DBG_FILE, "seek to negative offset (%p)\n", (void*)file);
+        return -1;
+    }
+
+    /* queue is re-started on next read if data is not already buffered */
+    uf->pos = offset;
+    return offset;
+}
+
+static int64_t _file_tell(BD_FILE_H *file)
+{
+    URING_FILE *uf = (URING_FILE *)file->internal;
+    return uf->pos;
+}
+
+static int64_t _file_read_sync(URING_FILE *uf, uint8_t *buf, int64_t size)
+{
+    ssize_t got, result;
+
+    for (got = 0; got < (ssize_t)size; got += result) {
+        result = pread(uf->fd, buf + got, size - got, (off_t)(uf->pos + got));
+        if (result < 0) {
+            if (errno != EINTR) {
+                BD_DEBUG(DBG_FILE, "pread() failed\n");
+                break;
+            }
+            result = 0;
+        } else if (result == 0) {
+            break;
+        }
+    }
+
+    uf->pos += got;
+    return (int64_t)got;
+}
+
+static int64_t _file_read(BD_FILE_H *file, uint8_t *buf, int64_t size)
+{
+    URING_FILE *uf = (URING_FILE *)file->internal;
+    int64_t     got = 0;
+
+    if (size <= 0 || size >= BD_MAX_SSIZE) {
+        BD_DEBUG(DBG_FILE | DBG_CRIT, "Ignoring invalid read of size %" PRId64 " (%p)\n", size, (void*)file);
+        return 0;
+    }
+
+    while (got < size && uf->pos < uf->size) {
+        URING_SLOT *s = &uf->slots[uf->head];
+        int64_t     n;
+
+        if (uf->failed) {
+            return got + _file_read_sync(uf, buf + got, size - got);
+        }
+
+        /* requested data not in queue ? */
+        if (!s->valid || uf->pos < s->offset ||
+            uf->pos >= s->offset + (s->pending ? URING_BUF_SIZE : s->result)) {
+
+            if (_restart(uf) < 0) {
+                return got + _file_read_sync(uf, buf + got, size - got);
+            }
+            continue;
+        }
+
+        while (s->pending) {
+            if (_reap_one(uf) < 0) {
+                return got + _file_read_sync(uf, buf + got, size - got);
+            }
+        }
+
+        if (s->result <= 0) {
+            /* read error. Retry synchronously to get consistent error handling. */
+            s->valid = 0;
+            return got + _file_read_sync(uf, buf + got, size - got);
+        }
+
+        if (uf->pos >= s->offset + s->result) {
+            /* short read */
+            continue;
+        }
+
+        n = BD_MIN(size - got, s->offset + s->result - uf->pos);
+        memcpy(buf + got, uf->bufs + (size_t)uf->head * URING_BUF_SIZE + (uf->pos - s->offset), (size_t)n);
+        got     += n;
+        uf->pos += n;
+
+        /* buffer consumed ? re-use it for next read */
+        if (uf->pos >= s->offset + URING_BUF_SIZE) {
+            if (_submit_slot(uf, uf->head) > 0) {
+                /* on failure, next read falls back to synchronous reads */
+                _submit(uf);
+            }
+            uf->head = (uf->head + 1) % uf->num_bufs;
+        }
+    }
+
+    return got;
+}
+
+static int64_t _file_read_at(BD_FILE_H *file, uint8_t *buf, int64_t size, int64_t offset)
+{
+    URING_FILE *uf = (URING_FILE *)file->internal;
+    ssize_t got, result;
+
+    if (size <= 0 || size >= BD_MAX_SSIZE || offset < 0) {
+        BD_DEBUG(DBG_FILE | DBG_CRIT, "Ignoring invalid read of size %" PRId64 " at %" PRId64 " (%p)\n", size, offset, (void*)file);
+        return 0;
+    }
+
+    /* queue belongs to sequential reader. Read synchronously. */
+    for (got = 0; got < (ssize_t)size; got += result) {
+        result = pread(uf->fd, buf + got, size - got, (off_t)(offset + got));
+        if (result < 0) {
+            if (errno != EINTR) {
+                BD_DEBUG(DBG_FILE, "pread() failed (%p)\n", (void*)file);
+                break;
+            }
+            result = 0;
+        } else if (result == 0) {
+            break;
+        }
+    }
+    return (int64_t)got;
+}
+
+BD_FILE_H *file_open_uring(const char *filename, unsigned num_units)
+{
+    BD_FILE_EXT *ext;
+    BD_FILE_H  *file;
+    URING_FILE *uf;
+    struct stat st;
+    int         flags = O_RDONLY;
+    int         ret;
+
+    /* custom file system in use ? */
+    if (file_open != file_open_default()) {
+        return NULL;
+    }
+
+    uf = calloc(1, sizeof(URING_FILE));
+    if (!uf) {
+        return NULL;
+    }
+
+    uf->num_bufs = (num_units * 6144 + URING_BUF_SIZE - 1) / URING_BUF_SIZE;
+    uf->num_bufs = BD_MAX(uf->num_bufs, URING_MIN_BUFS);
+
+    /* io_uring may be missing or disabled in running kernel */
+    ret = io_uring_queue_init(uf->num_bufs, &uf->ring, 0);
+    if (ret < 0) {
+        BD_DEBUG(DBG_FILE, "io_uring not available (%d)\n", ret);
+        X_FREE(uf);
+        return NULL;
+    }
+
+#ifdef O_CLOEXEC
+    flags |= O_CLOEXEC;
+#endif
+
+    if ((uf->fd = open(filename, flags)) < 0) {
+        BD_DEBUG(DBG_FILE, "Error opening file %s\n", filename);
+        goto error_ring;
+    }
+
+    if (fstat(uf->fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+        goto error_fd;
+    }
+    uf->size = (int64_t)st.st_size;
+
+    uf->bufs  = malloc((size_t)uf->num_bufs * URING_BUF_SIZE);
+    uf->slots = calloc(uf->num_bufs, sizeof(URING_SLOT));
+    ext = calloc(1, sizeof(BD_FILE_EXT));
+    if (!uf->bufs || !uf->slots || !ext) {
+        BD_DEBUG(DBG_FILE, "Error opening file %s (out of memory)\n", filename);
+        X_FREE(ext);
+        X_FREE(uf->slots);
+        X_FREE(uf->bufs);
+        goto error_fd;
+    }
+
+    ext->read_at = _file_read_at;
+
+    file = &ext->file;
+    file->close   = _file_close;
+    file->seek    = _file_seek;
+    file->read    = _file_read;
+    file->tell    = _file_tell;
+
+    file->internal = uf;
+
+    BD_DEBUG(DBG_FILE, "Opened io_uring file %s (%p), %u reads in flight\n", filename, (void*)file, uf->num_bufs);
+    return file;
+
+ error_fd:
+    close(uf->fd);
+ error_ring:
+    io_uring_queue_exit(&uf->ring);
+    X_FREE(uf);
+    return NULL;
+}
@@ -105,6 +105,7 @@ static int64_t _file_write(BD_FILE_H *file, const uint8_t *buf, int64_t size)
 
 static BD_FILE_H *_file_open(const char* filename, const char *mode)
 {
+    BD_FILE_EXT *ext;
     BD_FILE_H *file;
     FILE *fp;
     wchar_t wfilename[MAX_PATH], wmode[8];
@@ -122,12 +123,14 @@ static BD_FILE_H *_file_open(const char* filename, const char *mode)
         return NULL;
     }
 
-    file = calloc(1, sizeof(BD_FILE_H));
-    if (!file) {
+    /* allocated as BD_FILE_EXT (no positional reads) */
+    ext = calloc(1, sizeof(BD_FILE_EXT));
+    if (!ext) {
         BD_DEBUG(DBG_FILE | DBG_CRIT, "Error opening file %s (out of memory)\n", filename);
         fclose(fp);
         return NULL;
     }
+    file = &ext->file;
 
     file->internal = fp;
     file->close    = _file_close;
@@ -143,11 +146,34 @@ static BD_FILE_H *_file_open(const char* filename, const char *mode)
 
 BD_FILE_H* (*file_open)(const char* filename, const char *mode) = _file_open;
 
+BD_FILE_EXT *file_open_ext(const char *filename, int use_mmap)
+{
+    (void)use_mmap;
+
+    /* allocated as BD_FILE_EXT */
+    return (BD_FILE_EXT *)_file_open(filename, "rb");
+}
+
 BD_FILE_OPEN file_open_default(void)
 {
     return _file_open;
 }
 
+BD_FILE_H *file_open_mmap(const char *filename)
+{
+    /* not implemented */
+    (void)filename;
+    return NULL;
+}
+
+void file_prefetch(const char *filename, int64_t offset, int64_t size)
+{
+    /* not implemented */
+    (void)filename;
+    (void)offset;
+    (void)size;
+}
+
 int file_unlink(const char *file)
 {
     wchar_t wfile[MAX_PATH];
@@ -495,16 +495,18 @@ static int _parse_header(BITSTREAM *bs, uint32_t *bdjo_version)
     return 1;
 }
 
-static BDJO *_bdjo_parse(BD_FILE_H *fp)
+static BDJO *_bdjo_parse(const uint8_t *data, size_t size)
 {
     BITSTREAM   bs;
     BDJO       *p;
 
-    if (bs_init(&bs, fp) < 0) {
+    if (!data || !size) {
         BD_DEBUG(DBG_BDJ, "?????.bdjo: read error\n");
         return NULL;
     }
 
+    bs_init_mem(&bs, data, size);
+
     p = calloc(1, sizeof(BDJO));
     if (!p) {
         BD_DEBUG(DBG_BDJ | DBG_CRIT, "Out of memory\n");
@@ -541,6 +543,8 @@ BDJO *bdjo_parse(const char *path)
 {
     BD_FILE_H *fp;
     BDJO      *bdjo;
+    uint8_t   *data;
+    size_t     size;
 
     fp = file_open(path, "rb");
     if (!fp) {
@@ -548,23 +552,27 @@ BDJO *bdjo_parse(const char *path)
         return NULL;
     }
 
-    bdjo = _bdjo_parse(fp);
+    size = file_read_all(fp, &data);
     file_close(fp);
+
+    bdjo = _bdjo_parse(data, size);
+    X_FREE(data);
     return bdjo;
 }
 
 static BDJO *_bdjo_get(BD_DISC *disc, const char *dir, const char *file)
 {
-    BD_FILE_H *fp;
     BDJO      *bdjo;
+    uint8_t   *data;
+    size_t     size;
 
-    fp = disc_open_file(disc, dir, file);
-    if (!fp) {
+    size = disc_read_file(disc, dir, file, &data);
+    if (!size) {
         return NULL;
     }
 
-    bdjo = _bdjo_parse(fp);
-    file_close(fp);
+    bdjo = _bdjo_parse(data, size);
+    X_FREE(data);
 
     return bdjo;
 }
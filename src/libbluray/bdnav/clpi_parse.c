@@ -418,6 +418,251 @@ _parse_cpi_info(BITSTREAM *bits, CLPI_CL *cl)
     return _parse_cpi(bits, &cl->cpi);
 }
 
+/*
+ * EP map search index
+ *
+ * Entry points of cpi.entry[0] are flattened to arrays of absolute PTS / SPN
+ * values. Index is built only when EP map is sorted; searches then use binary
+ * search. Otherwise (or without index) EP map is scanned linearly.
+ */
+
+struct clpi_ep_index {
+    uint32_t *pts;         /* entry point PTS (45 kHz) of each fine entry */
+    uint32_t *spn;         /* entry point SPN of each fine entry */
+    int      *next_angle;  /* first angle change point at or after each fine entry, -1 if none */
+};
+
+/* CLPI_CL objects are allocated with private data. CLPI_CL is visible in public API. */
+typedef struct {
+    CLPI_CL               cl;        /* must be first */
+    struct clpi_ep_index *ep_index;  /* search index for cpi.entry[0] EP map */
+} CLPI_CL_PRIV;
+
+static const struct clpi_ep_index *
+_ep_index(const CLPI_CL *cl)
+{
+    return ((const CLPI_CL_PRIV *)cl)->ep_index;
+}
+
+static void
+_free_ep_index(struct clpi_ep_index **p)
+{
+    if (*p) {
+        X_FREE((*p)->pts);
+        X_FREE((*p)->spn);
+        X_FREE((*p)->next_angle);
+        X_FREE(*p);
+    }
+}
+
+static uint32_t
+_ep_coarse_pts(const CLPI_EP_COARSE *coarse)
+{
+    return (uint32_t)(coarse->pts_ep & ~0x01) << 18;
+}
+
+static uint32_t
+_ep_coarse_spn(const CLPI_EP_COARSE *coarse)
+{
+    return coarse->spn_ep & ~0x1FFFF;
+}
+
+static void
+_build_ep_index(CLPI_CL *cl)
+{
+    CLPI_CL_PRIV *priv = (CLPI_CL_PRIV *)cl;
+    const CLPI_EP_MAP_ENTRY *entry;
+    struct clpi_ep_index *idx;
+    int ii, jj, end, next;
+
+    _free_ep_index(&priv->ep_index);
+
+    if (cl->cpi.num_stream_pid < 1 || !cl->cpi.entry) {
+        return;
+    }
+    entry = &cl->cpi.entry[0];
+    if (entry->num_ep_coarse < 1 || entry->num_ep_fine < 1 || !entry->coarse || !entry->fine) {
+        return;
+    }
+
+    /* each fine entry must belong to exactly one coarse entry */
+    if (entry->coarse[0].ref_ep_fine_id != 0) {
+        return;
+    }
+    for (ii = 1; ii < entry->num_ep_coarse; ii++) {
+        if (entry->coarse[ii].ref_ep_fine_id <= entry->coarse[ii-1].ref_ep_fine_id ||
+            entry->coarse[ii].ref_ep_fine_id >= entry->num_ep_fine ||
+            entry->coarse[ii].spn_ep < entry->coarse[ii-1].spn_ep) {
+            return;
+        }
+    }
+
+    idx = calloc(1, sizeof(*idx));
+    if (!idx) {
+        return;
+    }
+    idx->pts        = malloc(entry->num_ep_fine * sizeof(uint32_t));
+    idx->spn        = malloc(entry->num_ep_fine * sizeof(uint32_t));
+    idx->next_angle = malloc(entry->num_ep_fine * sizeof(int));
+    if (!idx->pts || !idx->spn || !idx->next_angle) {
+        _free_ep_index(&idx);
+        return;
+    }
+
+    for (ii = 0; ii < entry->num_ep_coarse; ii++) {
+        uint32_t coarse_pts = _ep_coarse_pts(&entry->coarse[ii]);
+        uint32_t coarse_spn = _ep_coarse_spn(&entry->coarse[ii]);
+        end = (ii < entry->num_ep_coarse - 1) ? entry->coarse[ii+1].ref_ep_fine_id : entry->num_ep_fine;
+        for (jj = entry->coarse[ii].ref_ep_fine_id; jj < end; jj++) {
+            idx->pts[jj] = coarse_pts + ((uint32_t)entry->fine[jj].pts_ep << 8);
+            idx->spn[jj] = coarse_spn + entry->fine[jj].spn_ep;
+            if (jj > 0 && (idx->pts[jj] < idx->pts[jj-1] || idx->spn[jj] < idx->spn[jj-1])) {
+                BD_DEBUG(DBG_NAV, "clpi: EP map not sorted, using linear search\n");
+                _free_ep_index(&idx);
+                return;
+            }
+        }
+    }
+
+    next = -1;
+    for (jj = entry->num_ep_fine - 1; jj >= 0; jj--) {
+        if (entry->fine[jj].is_angle_change_point) {
+            next = jj;
+        }
+        idx->next_angle[jj] = next;
+    }
+
+    priv->ep_index = idx;
+}
+
+/* first coarse entry in [lo, num_ep_coarse) with spn_ep >= spn */
+static int
+_coarse_spn_ge(const CLPI_EP_MAP_ENTRY *entry, const struct clpi_ep_index *idx, int lo, uint32_t spn)
+{
+    int hi = entry->num_ep_coarse;
+
+    if (!idx) {
+        while (lo < hi && entry->coarse[lo].spn_ep < spn) {
+            lo++;
+        }
+        return lo;
+    }
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (entry->coarse[mid].spn_ep < spn) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* first coarse entry in [lo, num_ep_coarse) with entry point PTS > pts */
+static int
+_coarse_pts_gt(const CLPI_EP_MAP_ENTRY *entry, const struct clpi_ep_index *idx, int lo, uint32_t pts)
+{
+    int hi = entry->num_ep_coarse;
+
+    if (!idx) {
+        for (; lo < hi; lo++) {
+            int ref = entry->coarse[lo].ref_ep_fine_id;
+            if (_ep_coarse_pts(&entry->coarse[lo]) + ((uint32_t)entry->fine[ref].pts_ep << 8) > pts) {
+                break;
+            }
+        }
+        return lo;
+    }
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (idx->pts[entry->coarse[mid].ref_ep_fine_id] <= pts) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* first coarse entry with entry point SPN > spn */
+static int
+_coarse_spn_gt(const CLPI_EP_MAP_ENTRY *entry, const struct clpi_ep_index *idx, uint32_t spn)
+{
+    int lo = 0, hi = entry->num_ep_coarse;
+
+    if (!idx) {
+        for (; lo < hi; lo++) {
+            int ref = entry->coarse[lo].ref_ep_fine_id;
+            if (_ep_coarse_spn(&entry->coarse[lo]) + entry->fine[ref].spn_ep > spn) {
+                break;
+            }
+        }
+        return lo;
+    }
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (idx->spn[entry->coarse[mid].ref_ep_fine_id] <= spn) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* first fine entry in [lo, hi) (of coarse entry ii) with PTS > pts */
+static int
+_fine_pts_gt(const CLPI_EP_MAP_ENTRY *entry, const struct clpi_ep_index *idx, int ii, int lo, int hi, uint32_t pts)
+{
+    if (!idx) {
+        uint32_t coarse_pts = _ep_coarse_pts(&entry->coarse[ii]);
+        for (; lo < hi; lo++) {
+            if (coarse_pts + ((uint32_t)entry->fine[lo].pts_ep << 8) > pts) {
+                break;
+            }
+        }
+        return lo;
+    }
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (idx->pts[mid] <= pts) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* first fine entry in [lo, hi) (of coarse entry ii) with SPN >= spn */
+static int
+_fine_spn_ge(const CLPI_EP_MAP_ENTRY *entry, const struct clpi_ep_index *idx, int ii, int lo, int hi, uint32_t spn)
+{
+    if (!idx) {
+        uint32_t coarse_spn = _ep_coarse_spn(&entry->coarse[ii]);
+        for (; lo < hi; lo++) {
+            if (coarse_spn + entry->fine[lo].spn_ep >= spn) {
+                break;
+            }
+        }
+        return lo;
+    }
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (idx->spn[mid] < spn) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
 uint32_t
 clpi_find_stc_spn(const CLPI_CL *cl, uint8_t stc_id)
 {
@@ -461,17 +706,13 @@ clpi_lookup_spn(const CLPI_CL *cl, uint32_t timestamp, int before, uint8_t stc_i
     // PTS search. The spn_stc_start defines the point in
     // the EP map to start searching.
     stc_spn = clpi_find_stc_spn(cl, stc_id);
-    for (ii = 0; ii < entry->num_ep_coarse; ii++) {
-        ref = entry->coarse[ii].ref_ep_fine_id;
-        if (entry->coarse[ii].spn_ep >= stc_spn) {
-            // The desired starting point is either after this point
-            // or in the middle of the previous coarse entry
-            break;
-        }
-    }
+    // The desired starting point is either after this point
+    // or in the middle of the previous coarse entry
+    ii = _coarse_spn_ge(entry, _ep_index(cl), 0, stc_spn);
     if (ii >= entry->num_ep_coarse) {
         return cl->clip.num_source_packets;
     }
+    ref = entry->coarse[ii].ref_ep_fine_id;
     pts = ((uint64_t)(entry->coarse[ii].pts_ep & ~0x01) << 18) +
           ((uint64_t)entry->fine[ref].pts_ep << 8);
     if (pts > timestamp && ii) {
@@ -494,34 +735,20 @@ clpi_lookup_spn(const CLPI_CL *cl, uint32_t timestamp, int before, uint8_t stc_i
 
     // If we've gotten this far, the desired timestamp is somewhere
     // after the coarse entry we found the stc_spn in.
-    start = ii;
-    for (ii = start; ii < entry->num_ep_coarse; ii++) {
-        ref = entry->coarse[ii].ref_ep_fine_id;
-        pts = ((uint64_t)(entry->coarse[ii].pts_ep & ~0x01) << 18) +
-                ((uint64_t)entry->fine[ref].pts_ep << 8);
-        if (pts > timestamp) {
-            break;
-        }
-    }
+    ii = _coarse_pts_gt(entry, _ep_index(cl), ii, timestamp);
     // If the timestamp is before the first entry, then return
     // the beginning of the clip
     if (ii == 0) {
         return 0;
     }
     ii--;
-    coarse_pts = (uint32_t)(entry->coarse[ii].pts_ep & ~0x01) << 18;
     start = entry->coarse[ii].ref_ep_fine_id;
     if (ii < entry->num_ep_coarse - 1) {
         end = entry->coarse[ii+1].ref_ep_fine_id;
     } else {
         end = entry->num_ep_fine;
     }
-    for (jj = start; jj < end; jj++) {
-
-        pts = coarse_pts + ((uint32_t)entry->fine[jj].pts_ep << 8);
-        if (pts > timestamp)
-            break;
-    }
+    jj = _fine_pts_gt(entry, _ep_index(cl), ii, start, end, timestamp);
 
 done:
     if (before) {
@@ -550,18 +777,11 @@ clpi_access_point(const CLPI_CL *cl, uint32_t pkt, int next, int angle_change, u
     int ii, jj;
     uint32_t coarse_spn, spn;
     int start, end;
-    int ref;
 
     // Assumes that there is only one pid of interest
     entry = &cpi->entry[0];
 
-    for (ii = 0; ii < entry->num_ep_coarse; ii++) {
-        ref = entry->coarse[ii].ref_ep_fine_id;
-        spn = (entry->coarse[ii].spn_ep & ~0x1FFFF) + entry->fine[ref].spn_ep;
-        if (spn > pkt) {
-            break;
-        }
-    }
+    ii = _coarse_spn_gt(entry, _ep_index(cl), pkt);
     // If the timestamp is before the first entry, then return
     // the beginning of the clip
     if (ii == 0) {
@@ -569,23 +789,33 @@ clpi_access_point(const CLPI_CL *cl, uint32_t pkt, int next, int angle_change, u
         return 0;
     }
     ii--;
-    coarse_spn = (entry->coarse[ii].spn_ep & ~0x1FFFF);
+    coarse_spn = _ep_coarse_spn(&entry->coarse[ii]);
     start = entry->coarse[ii].ref_ep_fine_id;
     if (ii < entry->num_ep_coarse - 1) {
         end = entry->coarse[ii+1].ref_ep_fine_id;
     } else {
         end = entry->num_ep_fine;
     }
-    for (jj = start; jj < end; jj++) {
-
+    jj = _fine_spn_ge(entry, _ep_index(cl), ii, start, end, pkt);
+    if (jj < end) {
         spn = coarse_spn + entry->fine[jj].spn_ep;
-        if (spn >= pkt) {
-            break;
-        }
+    } else if (end > start) {
+        spn = coarse_spn + entry->fine[end - 1].spn_ep;
+    } else {
+        spn = coarse_spn;
     }
     if (jj == end && next) {
+        // first entry point of next coarse entry
         ii++;
-        jj = 0;
+        if (ii < entry->num_ep_coarse) {
+            start = entry->coarse[ii].ref_ep_fine_id;
+            if (ii < entry->num_ep_coarse - 1) {
+                end = entry->coarse[ii+1].ref_ep_fine_id;
+            } else {
+                end = entry->num_ep_fine;
+            }
+            jj = start;
+        }
     } else if (spn != pkt && !next) {
         jj--;
     }
@@ -593,7 +823,17 @@ clpi_access_point(const CLPI_CL *cl, uint32_t pkt, int next, int angle_change, u
         *time = 0;
         return cl->clip.num_source_packets;
     }
-    coarse_spn = (entry->coarse[ii].spn_ep & ~0x1FFFF);
+    coarse_spn = _ep_coarse_spn(&entry->coarse[ii]);
+    if (angle_change && _ep_index(cl)) {
+        const struct clpi_ep_index *idx = _ep_index(cl);
+        int angle_jj = idx->next_angle[jj];
+        if (angle_jj < 0) {
+            *time = 0;
+            return cl->clip.num_source_packets;
+        }
+        *time = idx->pts[angle_jj];
+        return idx->spn[angle_jj];
+    }
     if (angle_change) {
         // Keep looking till there's an angle change point
         for (; jj < end; jj++) {
@@ -616,7 +856,7 @@ clpi_access_point(const CLPI_CL *cl, uint32_t pkt, int next, int angle_change, u
                 if (entry->fine[jj].is_angle_change_point) {
                     *time = ((uint64_t)(entry->coarse[ii].pts_ep & ~0x01) << 18) +
                             ((uint64_t)entry->fine[jj].pts_ep << 8);
-                    return coarse_spn + entry->fine[jj].spn_ep;
+                    return _ep_coarse_spn(&entry->coarse[ii]) + entry->fine[jj].spn_ep;
                 }
             }
         }
@@ -731,6 +971,8 @@ _clpi_clean(void *p)
 
     _clean_program(&cl->program_ss);
     _clean_cpi(&cl->cpi_ss);
+
+    _free_ep_index(&((CLPI_CL_PRIV *)cl)->ep_index);
 }
 
 static void
@@ -758,17 +1000,19 @@ clpi_free(CLPI_CL **cl)
 }
 
 static CLPI_CL*
-_clpi_parse(BD_FILE_H *fp)
+_clpi_parse(const uint8_t *data, size_t size)
 {
     BITSTREAM  bits;
     CLPI_CL   *cl;
 
-    if (bs_init(&bits, fp) < 0) {
+    if (!data || !size) {
         BD_DEBUG(DBG_NAV, "?????.clpi: read error\n");
         return NULL;
     }
 
-    cl = refcnt_calloc(sizeof(CLPI_CL), _clpi_clean);
+    bs_init_mem(&bits, data, size);
+
+    cl = refcnt_calloc(sizeof(CLPI_CL_PRIV), _clpi_clean);
     if (cl == NULL) {
         BD_DEBUG(DBG_CRIT, "out of memory\n");
         return NULL;
@@ -803,6 +1047,8 @@ _clpi_parse(BD_FILE_H *fp)
         return NULL;
     }
 
+    _build_ep_index(cl);
+
     return cl;
 }
 
@@ -811,6 +1057,8 @@ clpi_parse(const char *path)
 {
     BD_FILE_H *fp;
     CLPI_CL   *cl;
+    uint8_t   *data;
+    size_t     size;
 
     fp = file_open(path, "rb");
     if (!fp) {
@@ -818,24 +1066,28 @@ clpi_parse(const char *path)
         return NULL;
     }
 
-    cl = _clpi_parse(fp);
+    size = file_read_all(fp, &data);
     file_close(fp);
+
+    cl = _clpi_parse(data, size);
+    X_FREE(data);
     return cl;
 }
 
 static CLPI_CL*
 _clpi_get(BD_DISC *disc, const char *dir, const char *file)
 {
-    BD_FILE_H *fp;
     CLPI_CL   *cl;
+    uint8_t   *data;
+    size_t     size;
 
-    fp = disc_open_file(disc, dir, file);
-    if (!fp) {
+    size = disc_read_file(disc, dir, file, &data);
+    if (!size) {
         return NULL;
     }
 
-    cl = _clpi_parse(fp);
-    file_close(fp);
+    cl = _clpi_parse(data, size);
+    X_FREE(data);
     return cl;
 }
 
@@ -869,7 +1121,7 @@ clpi_copy(const CLPI_CL* src_cl)
     int ii, jj;
 
     if (src_cl) {
-        dest_cl = refcnt_calloc(sizeof(CLPI_CL), _clpi_clean);
+        dest_cl = refcnt_calloc(sizeof(CLPI_CL_PRIV), _clpi_clean);
         if (!dest_cl) {
             goto fail;
         }
@@ -983,6 +1235,8 @@ clpi_copy(const CLPI_CL* src_cl)
             }
             memcpy(dest_cl->clip.font_info.font, src_cl->clip.font_info.font, dest_cl->clip.font_info.font_count * sizeof(CLPI_FONT));
         }
+
+        _build_ep_index(dest_cl);
     }
 
     return dest_cl;
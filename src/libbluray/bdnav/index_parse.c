@@ -247,17 +247,19 @@ _parse_indx_extension(BITSTREAM *bits, int id1, int id2, void *handle)
     return 0;
 }
 
-static INDX_ROOT *_indx_parse(BD_FILE_H *fp)
+static INDX_ROOT *_indx_parse(const uint8_t *data, size_t size)
 {
     BITSTREAM  bs;
     INDX_ROOT *index;
     uint32_t   indexes_start, extension_data_start;
 
-    if (bs_init(&bs, fp) < 0) {
+    if (!data || !size) {
         BD_DEBUG(DBG_NAV, "index.bdmv: read error\n");
         return NULL;
     }
 
+    bs_init_mem(&bs, data, size);
+
     index = calloc(1, sizeof(INDX_ROOT));
     if (!index) {
         BD_DEBUG(DBG_CRIT, "out of memory\n");
@@ -293,16 +295,17 @@ static INDX_ROOT *_indx_parse(BD_FILE_H *fp)
 
 static INDX_ROOT *_indx_get(BD_DISC *disc, const char *path)
 {
-    BD_FILE_H *fp;
     INDX_ROOT *index;
+    uint8_t   *data;
+    size_t     size;
 
-    fp = disc_open_path(disc, path);
-    if (!fp) {
+    size = disc_read_file(disc, NULL, path, &data);
+    if (!size) {
         return NULL;
     }
 
-    index = _indx_parse(fp);
-    file_close(fp);
+    index = _indx_parse(data, size);
+    X_FREE(data);
     return index;
 }
 
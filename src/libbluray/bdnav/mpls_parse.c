@@ -32,6 +32,7 @@
 #include "disc/disc.h"
 
 #include "file/file.h"
+#include "util/refcnt.h"
 #include "util/bits.h"
 #include "util/logging.h"
 #include "util/macro.h"
@@ -797,8 +798,9 @@ static void _clean_pip_data(MPLS_PIP_METADATA *p)
 }
 
 static void
-_clean_playlist(MPLS_PL *pl)
+_clean_playlist(void *p)
 {
+    MPLS_PL *pl = p;
     int ii;
 
     if (pl->play_item != NULL) {
@@ -828,14 +830,28 @@ _clean_playlist(MPLS_PL *pl)
 
     X_FREE(pl->ext_static_metadata);
     X_FREE(pl->play_mark);
-    X_FREE(pl);
+}
+
+static void
+_mpls_free(const MPLS_PL *pl)
+{
+    refcnt_dec(pl);
+}
+
+void
+mpls_unref(const MPLS_PL **pl)
+{
+    if (*pl) {
+        _mpls_free(*pl);
+        *pl = NULL;
+    }
 }
 
 void
 mpls_free(MPLS_PL **pl)
 {
     if (*pl) {
-        _clean_playlist(*pl);
+        _mpls_free(*pl);
         *pl = NULL;
     }
 }
@@ -1093,32 +1109,34 @@ _parse_mpls_extension(BITSTREAM *bits, int id1, int id2, void *handle)
 }
 
 static MPLS_PL*
-_mpls_parse(BD_FILE_H *fp)
+_mpls_parse(const uint8_t *data, size_t size)
 {
     BITSTREAM  bits;
     MPLS_PL   *pl = NULL;
 
-    if (bs_init(&bits, fp) < 0) {
+    if (!data || !size) {
         BD_DEBUG(DBG_NAV, "?????.mpls: read error\n");
         return NULL;
     }
 
-    pl = calloc(1, sizeof(MPLS_PL));
+    bs_init_mem(&bits, data, size);
+
+    pl = refcnt_calloc(sizeof(MPLS_PL), _clean_playlist);
     if (pl == NULL) {
         BD_DEBUG(DBG_CRIT, "out of memory\n");
         return NULL;
     }
 
     if (!_parse_header(&bits, pl)) {
-        _clean_playlist(pl);
+        _mpls_free(pl);
         return NULL;
     }
     if (!_parse_playlist(&bits, pl)) {
-        _clean_playlist(pl);
+        _mpls_free(pl);
         return NULL;
     }
     if (!_parse_playlistmark(&bits, pl)) {
-        _clean_playlist(pl);
+        _mpls_free(pl);
         return NULL;
     }
 
@@ -1137,6 +1155,8 @@ mpls_parse(const char *path)
 {
     MPLS_PL   *pl;
     BD_FILE_H *fp;
+    uint8_t   *data;
+    size_t     size;
 
     fp = file_open(path, "rb");
     if (!fp) {
@@ -1144,38 +1164,56 @@ mpls_parse(const char *path)
         return NULL;
     }
 
-    pl = _mpls_parse(fp);
+    size = file_read_all(fp, &data);
     file_close(fp);
+
+    pl = _mpls_parse(data, size);
+    X_FREE(data);
     return pl;
 }
 
+MPLS_PL*
+mpls_parse_mem(const uint8_t *data, size_t size)
+{
+    return _mpls_parse(data, size);
+}
+
 static MPLS_PL*
 _mpls_get(BD_DISC *disc, const char *dir, const char *file)
 {
     MPLS_PL   *pl;
-    BD_FILE_H *fp;
+    uint8_t   *data;
+    size_t     size;
 
-    fp = disc_open_file(disc, dir, file);
-    if (!fp) {
+    size = disc_read_file(disc, dir, file, &data);
+    if (!size) {
         return NULL;
     }
 
-    pl = _mpls_parse(fp);
-    file_close(fp);
+    pl = _mpls_parse(data, size);
+    X_FREE(data);
     return pl;
 }
 
-MPLS_PL*
+const MPLS_PL*
 mpls_get(BD_DISC *disc, const char *file)
 {
-    MPLS_PL *pl;
+    const MPLS_PL *pl;
 
-    pl = _mpls_get(disc, "BDMV" DIR_SEP "PLAYLIST", file);
+    pl = disc_cache_get(disc, file);
     if (pl) {
         return pl;
     }
 
-    /* if failed, try backup file */
-    pl = _mpls_get(disc, "BDMV" DIR_SEP "BACKUP" DIR_SEP "PLAYLIST", file);
+    pl = _mpls_get(disc, "BDMV" DIR_SEP "PLAYLIST", file);
+    if (!pl) {
+        /* if failed, try backup file */
+        pl = _mpls_get(disc, "BDMV" DIR_SEP "BACKUP" DIR_SEP "PLAYLIST", file);
+    }
+
+    if (pl) {
+        disc_cache_put(disc, file, pl);
+    }
+
     return pl;
 }
@@ -23,13 +23,19 @@
 
 #include "util/attributes.h"
 
+#include <stddef.h>
 #include <stdint.h>
 
 struct bd_disc;
 struct mpls_pl;
 
+/* cached in disc, shared between users */
+BD_PRIVATE const struct mpls_pl *mpls_get(struct bd_disc *disc, const char *file);
+BD_PRIVATE void                  mpls_unref(const struct mpls_pl **pl);
+
+/* uncached, owned by caller */
 BD_PRIVATE struct mpls_pl *mpls_parse(const char *path);
-BD_PRIVATE struct mpls_pl *mpls_get(struct bd_disc *disc, const char *file);
+BD_PRIVATE struct mpls_pl *mpls_parse_mem(const uint8_t *data, size_t size);
 BD_PRIVATE void mpls_free(struct mpls_pl **pl);
 
 #endif // _MPLS_PARSE_H_
@@ -35,6 +35,7 @@
 #include "util/macro.h"
 #include "util/logging.h"
 #include "util/strutl.h"
+#include "util/thread.h"
 #include "file/file.h"
 
 #include <stdlib.h>
@@ -198,16 +199,147 @@ static int _pl_cmp(const MPLS_PL *pl1, const MPLS_PL *pl2)
 }
 
 /*
- * Playlist filtering
+ * Playlist fingerprint
+ *
+ * Hash covers exactly the fields compared in _pl_cmp():
+ * equal playlists always have equal fingerprint.
  */
 
-/* return 0 if duplicate playlist */
-static int _filter_dup(MPLS_PL *pl_list[], unsigned count, const MPLS_PL *pl)
+#define FP_INIT  UINT64_C(0xcbf29ce484222325)  /* FNV-1a */
+
+static uint64_t _fp_u32(uint64_t h, uint32_t v)
 {
     unsigned ii;
+    for (ii = 0; ii < 4; ii++, v >>= 8) {
+        h ^= (v & 0xff);
+        h *= UINT64_C(0x100000001b3);
+    }
+    return h;
+}
 
+static uint64_t _fp_bytes(uint64_t h, const void *data, unsigned len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    unsigned ii;
+    for (ii = 0; ii < len; ii++) {
+        h ^= p[ii];
+        h *= UINT64_C(0x100000001b3);
+    }
+    return h;
+}
+
+static uint64_t _fp_streams(uint64_t h, const MPLS_STREAM *s, unsigned count)
+{
+    unsigned ii;
     for (ii = 0; ii < count; ii++) {
-        if (!_pl_cmp(pl, pl_list[ii])) {
+        h = _fp_u32(h, s[ii].stream_type | (s[ii].coding_type << 8) | ((uint32_t)s[ii].pid << 16));
+        h = _fp_u32(h, s[ii].subpath_id | (s[ii].subclip_id << 8) | (s[ii].format << 16) | ((uint32_t)s[ii].rate << 24));
+        h = _fp_u32(h, s[ii].char_code | (s[ii].color_space << 8));
+        h = _fp_bytes(h, s[ii].lang, 4);
+    }
+    return h;
+}
+
+static uint64_t _pl_fingerprint(const MPLS_PL *pl)
+{
+    uint64_t h = FP_INIT;
+    unsigned ii;
+
+    h = _fp_u32(h, pl->list_count);
+    h = _fp_u32(h, pl->mark_count);
+    h = _fp_u32(h, pl->sub_count);
+    h = _fp_u32(h, pl->ext_sub_count);
+
+    for (ii = 0; ii < pl->mark_count; ii++) {
+        const MPLS_PLM *pm = &pl->play_mark[ii];
+        h = _fp_u32(h, pm->mark_type | ((uint32_t)pm->play_item_ref << 8));
+        h = _fp_u32(h, pm->entry_es_pid);
+        h = _fp_u32(h, pm->time);
+        h = _fp_u32(h, pm->duration);
+    }
+
+    for (ii = 0; ii < pl->list_count; ii++) {
+        const MPLS_PI *pi = &pl->play_item[ii];
+        h = _fp_bytes(h, pi->clip[0].clip_id, 5);
+        h = _fp_u32(h, pi->in_time);
+        h = _fp_u32(h, pi->out_time);
+        h = _fp_u32(h, pi->stn.num_video | (pi->stn.num_audio << 8) | (pi->stn.num_pg << 16) | ((uint32_t)pi->stn.num_ig << 24));
+        h = _fp_u32(h, pi->stn.num_secondary_audio | (pi->stn.num_secondary_video << 8));
+        h = _fp_streams(h, pi->stn.video,           pi->stn.num_video);
+        h = _fp_streams(h, pi->stn.audio,           pi->stn.num_audio);
+        h = _fp_streams(h, pi->stn.pg,              pi->stn.num_pg);
+        h = _fp_streams(h, pi->stn.ig,              pi->stn.num_ig);
+        h = _fp_streams(h, pi->stn.secondary_audio, pi->stn.num_secondary_audio);
+        h = _fp_streams(h, pi->stn.secondary_video, pi->stn.num_secondary_video);
+    }
+
+    return h;
+}
+
+/*
+ * Set of accepted playlists, indexed by fingerprint
+ */
+
+#define PL_SET_NONE  UINT32_MAX
+
+typedef struct {
+    uint32_t        mask;   /* number of buckets - 1 */
+    uint32_t       *head;   /* first playlist in bucket */
+    uint32_t       *next;   /* next playlist in same bucket */
+    const uint64_t *hash;   /* fingerprint of each playlist */
+    const MPLS_PL **pl;
+} PL_SET;
+
+static int _pl_set_init(PL_SET *set, unsigned max_count, const MPLS_PL **pl_list, const uint64_t *hash)
+{
+    uint32_t size = 64;
+
+    while (size < 2 * max_count) {
+        size <<= 1;
+    }
+
+    set->mask = size - 1;
+    set->pl   = pl_list;
+    set->hash = hash;
+    set->head = malloc(size * sizeof(uint32_t));
+    set->next = malloc((max_count + 1) * sizeof(uint32_t));
+    if (!set->head || !set->next) {
+        X_FREE(set->head);
+        X_FREE(set->next);
+        return -1;
+    }
+
+    memset(set->head, 0xff, size * sizeof(uint32_t));
+    return 0;
+}
+
+static void _pl_set_free(PL_SET *set)
+{
+    X_FREE(set->head);
+    X_FREE(set->next);
+}
+
+/* add playlist pl_list[idx] */
+static void _pl_set_add(PL_SET *set, uint32_t idx)
+{
+    uint32_t b = (uint32_t)set->hash[idx] & set->mask;
+
+    set->next[idx] = set->head[b];
+    set->head[b]   = idx;
+}
+
+/*
+ * Playlist filtering
+ */
+
+/* return 0 if duplicate playlist */
+static int _filter_dup(const PL_SET *set, uint64_t hash, const MPLS_PL *pl)
+{
+    uint32_t ii;
+
+    /* full compare only on fingerprint match */
+    for (ii = set->head[(uint32_t)hash & set->mask]; ii != PL_SET_NONE; ii = set->next[ii]) {
+        if (set->hash[ii] == hash && !_pl_cmp(pl, set->pl[ii])) {
             return 0;
         }
     }
@@ -390,33 +522,137 @@ static int _pl_guess_main_title(const MPLS_PL *p1, const MPLS_PL *p2,
  * title list
  */
 
-NAV_TITLE_LIST* nav_get_title_list(BD_DISC *disc, uint32_t flags, uint32_t min_title_length)
+#define NAV_SCAN_THREADS       4   /* max. number of playlist parser threads */
+#define NAV_SCAN_MIN_PARALLEL  32  /* use threads only when there are more playlists */
+
+typedef struct {
+    char          *name;
+    uint8_t       *data;
+    size_t         size;
+    const MPLS_PL *pl;
+    uint64_t       hash;
+} NAV_PL_ENTRY;
+
+static void _parse_pl_job(void *arg, unsigned idx)
+{
+    NAV_PL_ENTRY *e = (NAV_PL_ENTRY *)arg + idx;
+
+    if (e->data) {
+        e->pl = mpls_parse_mem(e->data, e->size);
+        X_FREE(e->data);
+        if (e->pl) {
+            e->hash = _pl_fingerprint(e->pl);
+        }
+    }
+}
+
+/*
+ * Read and parse all playlists.
+ * File system access is not thread-safe: files are read sequentially and
+ * only parsing is done in parallel. Result is stored in directory order.
+ */
+static int _scan_playlists(BD_DISC *disc, NAV_PL_ENTRY **p_list, unsigned *count)
 {
     BD_DIR_H *dir;
     BD_DIRENT ent;
-    MPLS_PL **pl_list = NULL;
-    MPLS_PL *pl = NULL;
-    unsigned int ii, pl_list_size = 0;
+    NAV_PL_ENTRY *list = NULL;
+    unsigned ii, list_size = 0;
     int res;
+
+    *p_list = NULL;
+    *count  = 0;
+
+    dir = disc_open_dir(disc, "BDMV" DIR_SEP "PLAYLIST");
+    if (dir == NULL) {
+        return -1;
+    }
+
+    for (res = dir_read(dir, &ent); !res; res = dir_read(dir, &ent)) {
+
+        if (ent.d_name[0] == '.') {
+            continue;
+        }
+        if (*count >= list_size) {
+            NAV_PL_ENTRY *tmp;
+
+            list_size += 100;
+            tmp = realloc(list, list_size * sizeof(NAV_PL_ENTRY));
+            if (tmp == NULL) {
+                break;
+            }
+            list = tmp;
+        }
+
+        list[*count].name = str_dup(ent.d_name);
+        list[*count].data = NULL;
+        list[*count].size = 0;
+        list[*count].pl   = NULL;
+        list[*count].hash = 0;
+        if (!list[*count].name) {
+            break;
+        }
+
+        list[*count].size = disc_read_file(disc, "BDMV" DIR_SEP "PLAYLIST", ent.d_name, &list[*count].data);
+        (*count)++;
+    }
+    dir_close(dir);
+
+    if (*count > NAV_SCAN_MIN_PARALLEL) {
+        BD_THREAD_POOL *pool = bd_thread_pool_init();
+        if (pool) {
+            bd_thread_pool_set_threads(pool, NAV_SCAN_THREADS);
+        }
+        bd_thread_pool_run(pool, _parse_pl_job, list, *count);
+        bd_thread_pool_free(&pool);
+    } else {
+        for (ii = 0; ii < *count; ii++) {
+            _parse_pl_job(list, ii);
+        }
+    }
+
+    /* failed playlists: try again (and with backup file) */
+    for (ii = 0; ii < *count; ii++) {
+        if (!list[ii].pl) {
+            list[ii].pl = mpls_get(disc, list[ii].name);
+            if (list[ii].pl) {
+                list[ii].hash = _pl_fingerprint(list[ii].pl);
+            }
+        }
+    }
+
+    *p_list = list;
+    return 0;
+}
+
+NAV_TITLE_LIST* nav_get_title_list(BD_DISC *disc, uint32_t flags, uint32_t min_title_length)
+{
+    NAV_PL_ENTRY *entries;
+    const MPLS_PL **pl_list = NULL;
+    uint64_t *pl_hash = NULL;
+    const MPLS_PL *pl = NULL;
+    PL_SET pl_set;
+    unsigned int ii, jj, num_entries = 0;
     NAV_TITLE_LIST *title_list = NULL;
     unsigned int title_info_alloc = 100;
     char *known_mpls_ids;
 
-    dir = disc_open_dir(disc, "BDMV" DIR_SEP "PLAYLIST");
-    if (dir == NULL) {
+    if (_scan_playlists(disc, &entries, &num_entries) < 0) {
         return NULL;
     }
 
     title_list = calloc(1, sizeof(NAV_TITLE_LIST));
-    if (!title_list) {
-        dir_close(dir);
-        return NULL;
-    }
-    title_list->title_info = calloc(title_info_alloc, sizeof(NAV_TITLE_INFO));
-    if (!title_list->title_info) {
+    pl_list    = calloc(num_entries + 1, sizeof(MPLS_PL*));
+    pl_hash    = calloc(num_entries + 1, sizeof(uint64_t));
+    if (title_list) {
+        title_list->title_info = calloc(title_info_alloc, sizeof(NAV_TITLE_INFO));
+    }
+    if (!title_list || !title_list->title_info || !pl_list || !pl_hash ||
+        _pl_set_init(&pl_set, num_entries, pl_list, pl_hash) < 0) {
+        if (title_list) {
+            X_FREE(title_list->title_info);
+        }
         X_FREE(title_list);
-        dir_close(dir);
-        return NULL;
+        goto out;
     }
 
     known_mpls_ids = disc_property_get(disc, DISC_PROPERTY_MAIN_FEATURE);
@@ -424,36 +660,24 @@ NAV_TITLE_LIST* nav_get_title_list(BD_DISC *disc, uint32_t flags, uint32_t min_t
         known_mpls_ids = disc_property_get(disc, DISC_PROPERTY_PLAYLISTS);
     }
 
+    /* merge in directory order */
     ii = 0;
-    for (res = dir_read(dir, &ent); !res; res = dir_read(dir, &ent)) {
+    for (jj = 0; jj < num_entries; jj++) {
+        const char *name = entries[jj].name;
 
-        if (ent.d_name[0] == '.') {
-            continue;
-        }
-        if (ii >= pl_list_size) {
-            MPLS_PL **tmp = NULL;
-
-            pl_list_size += 100;
-            tmp = realloc(pl_list, pl_list_size * sizeof(MPLS_PL*));
-            if (tmp == NULL) {
-                break;
-            }
-            pl_list = tmp;
-        }
-        pl = mpls_get(disc, ent.d_name);
+        pl = entries[jj].pl;
         if (pl != NULL) {
-            if ((flags & TITLES_FILTER_DUP_TITLE) &&
-                !_filter_dup(pl_list, ii, pl)) {
-                mpls_free(&pl);
+            uint64_t hash = entries[jj].hash;
+            int      uniq = _filter_dup(&pl_set, hash, pl);
+
+            if ((flags & TITLES_FILTER_DUP_TITLE) && !uniq) {
                 continue;
             }
             if ((flags & TITLES_FILTER_DUP_CLIP) && !_filter_repeats(pl, 2)) {
-                mpls_free(&pl);
                 continue;
             }
             if (min_title_length > 0 &&
                 _pl_duration(pl) < min_title_length*45000) {
-                mpls_free(&pl);
                 continue;
             }
             if (ii >= title_info_alloc) {
@@ -468,35 +692,42 @@ NAV_TITLE_LIST* nav_get_title_list(BD_DISC *disc, uint32_t flags, uint32_t min_t
                 title_list->title_info = tmp;
             }
             pl_list[ii] = pl;
+            pl_hash[ii] = hash;
+            _pl_set_add(&pl_set, ii);
 
             /* main title guessing */
-            if (_filter_dup(pl_list, ii, pl) &&
-                _filter_repeats(pl, 2)) {
+            if (uniq && _filter_repeats(pl, 2)) {
 
                 if (_pl_guess_main_title(pl_list[ii], pl_list[title_list->main_title_idx],
-                                         ent.d_name,
+                                         name,
                                          title_list->title_info[title_list->main_title_idx].name,
                                          known_mpls_ids) <= 0) {
                     title_list->main_title_idx = ii;
                 }
             }
 
-            memcpy(title_list->title_info[ii].name, ent.d_name, 10);
+            memcpy(title_list->title_info[ii].name, name, 10);
             title_list->title_info[ii].name[10] = '\0';
             title_list->title_info[ii].ref = ii;
-            title_list->title_info[ii].mpls_id  = atoi(ent.d_name);
+            title_list->title_info[ii].mpls_id  = atoi(name);
             title_list->title_info[ii].duration = _pl_duration(pl_list[ii]);
             ii++;
         }
     }
-    dir_close(dir);
 
     title_list->count = ii;
-    for (ii = 0; ii < title_list->count; ii++) {
-        mpls_free(&pl_list[ii]);
-    }
     X_FREE(known_mpls_ids);
+    _pl_set_free(&pl_set);
+
+ out:
+    for (jj = 0; jj < num_entries; jj++) {
+        mpls_unref(&entries[jj].pl);
+        X_FREE(entries[jj].name);
+        X_FREE(entries[jj].data);
+    }
+    X_FREE(entries);
     X_FREE(pl_list);
+    X_FREE(pl_hash);
     return title_list;
 }
 
@@ -588,6 +819,9 @@ _extrapolate_title(NAV_TITLE *title)
         clip->title_pkt = pkt;
         duration += clip->duration;
         pkt += clip->end_pkt - clip->start_pkt;
+
+        title->clip_end_time[ii] = duration;
+        title->clip_end_pkt[ii] = pkt;
     }
     title->duration = duration;
     title->packets = pkt;
@@ -626,10 +860,10 @@ static void _fill_clip(NAV_TITLE *title,
                        uint8_t connection_condition, uint32_t in_time, uint32_t out_time,
                        unsigned pi_angle_count, unsigned still_mode, unsigned still_time,
                        NAV_CLIP *clip,
-                       unsigned ref, uint32_t *pos, uint32_t *time)
+                       unsigned ref)
 
 {
-    char *file;
+    char name[11];
 
     clip->title = title;
     clip->ref   = ref;
@@ -642,52 +876,159 @@ static void _fill_clip(NAV_TITLE *title,
         clip->angle = title->angle;
     }
 
-    memcpy(clip->name, mpls_clip[clip->angle].clip_id, 5);
+    memcpy(name, mpls_clip[clip->angle].clip_id, 5);
     if (!memcmp(mpls_clip[clip->angle].codec_id, "FMTS", 4))
-        memcpy(&clip->name[5], ".fmts", 6);
+        memcpy(&name[5], ".fmts", 6);
     else
-        memcpy(&clip->name[5], ".m2ts", 6);
+        memcpy(&name[5], ".m2ts", 6);
+
+    /* keep already loaded clip info when clip does not change (angle change) */
+    if (memcmp(clip->name, name, sizeof(name))) {
+        clpi_unref(&clip->cl);
+        clip->cl_loaded = 0;
+    }
+
+    memcpy(clip->name, name, sizeof(name));
     clip->clip_id = atoi(mpls_clip[clip->angle].clip_id);
+    clip->stc_id  = mpls_clip[clip->angle].stc_id;
+    clip->connection_condition = connection_condition;
+
+    clip->in_time  = in_time;
+    clip->out_time = out_time;
+}
+
+/* load clip info and find clip packet range */
+static int _load_clip(NAV_CLIP *clip)
+{
+    char *file;
 
-    clpi_unref(&clip->cl);
+    if (!clip->cl_loaded) {
+        clip->cl_loaded = 1;
 
-    file = str_printf("%s.clpi", mpls_clip[clip->angle].clip_id);
-    if (file) {
-        clip->cl = clpi_get(title->disc, file);
-        X_FREE(file);
+        file = str_printf("%5.5s.clpi", clip->name);
+        if (file) {
+            clip->cl = clpi_get(clip->title->disc, file);
+            X_FREE(file);
+        }
     }
+
     if (clip->cl == NULL) {
         clip->start_pkt = 0;
         clip->end_pkt = 0;
-        return;
+        return -1;
     }
 
-    switch (connection_condition) {
+    switch (clip->connection_condition) {
         case 5:
         case 6:
             clip->start_pkt = 0;
             clip->connection = CONNECT_SEAMLESS;
             break;
         default:
-            if (ref) {
-                clip->start_pkt = clpi_lookup_spn(clip->cl, in_time, 1,
-                                              mpls_clip[clip->angle].stc_id);
+            if (clip->ref) {
+                clip->start_pkt = clpi_lookup_spn(clip->cl, clip->in_time, 1, clip->stc_id);
             } else {
                 clip->start_pkt = 0;
             }
             clip->connection = CONNECT_NON_SEAMLESS;
             break;
     }
-    clip->end_pkt = clpi_lookup_spn(clip->cl, out_time, 0,
-                                    mpls_clip[clip->angle].stc_id);
-    clip->in_time = in_time;
-    clip->out_time = out_time;
-    clip->title_pkt = *pos;
-    *pos += clip->end_pkt - clip->start_pkt;
-    clip->title_time = *time;
-    *time += clip->out_time - clip->in_time;
+    clip->end_pkt = clpi_lookup_spn(clip->cl, clip->out_time, 0, clip->stc_id);
+
+    clip->stc_spn = clpi_find_stc_spn(clip->cl, clip->stc_id);
+
+    return 0;
+}
+
+/*
+ * Main path clip info is loaded when title is opened: clip packet ranges
+ * (start_pkt, end_pkt) are looked up from the EP map, and title size,
+ * byte position seeking and chapter packet positions need all of them.
+ */
+
+static void _fill_main_clips(NAV_TITLE *title)
+{
+    uint32_t pos = 0;
+    uint32_t time = 0;
+    unsigned ii;
+
+    // Find length in packets and end_pkt for each clip
+    for (ii = 0; ii < title->clip_list.count; ii++) {
+        const MPLS_PI *pi = &title->pl->play_item[ii];
+        NAV_CLIP *clip = &title->clip_list.clip[ii];
+
+        _fill_clip(title, pi->clip, pi->connection_condition, pi->in_time, pi->out_time, pi->angle_count,
+                   pi->still_mode, pi->still_time, clip, ii);
+
+        /* title packet metrics depend on main path clip info */
+        if (_load_clip(clip) < 0) {
+            clip->in_time = 0;
+            clip->out_time = 0;
+            clip->title_pkt = 0;
+            clip->title_time = 0;
+            continue;
+        }
+
+        clip->title_pkt = pos;
+        pos += clip->end_pkt - clip->start_pkt;
+        clip->title_time = time;
+        time += clip->out_time - clip->in_time;
+    }
+}
+
+/*
+ * Sub path clip info is not needed before the sub path is used
+ * (most sub paths are never played). It is loaded on first use.
+ */
+
+static void _fill_sub_clips(NAV_TITLE *title, unsigned ss)
+{
+    NAV_SUB_PATH *sub_path = &title->sub_path[ss];
+    uint32_t time = 0;
+    unsigned ii;
+
+    for (ii = 0; ii < sub_path->clip_list.count; ii++) {
+        const MPLS_SUB_PI *pi = &title->pl->sub_path[ss].sub_play_item[ii];
+        NAV_CLIP *clip = &sub_path->clip_list.clip[ii];
 
-    clip->stc_spn = clpi_find_stc_spn(clip->cl, mpls_clip[clip->angle].stc_id);
+        _fill_clip(title, pi->clip, pi->connection_condition, pi->in_time, pi->out_time, 0,
+                   0, 0, clip, ii);
+
+        clip->title_time = time;
+        time += clip->out_time - clip->in_time;
+    }
+}
+
+int nav_clip_load(NAV_CLIP *clip)
+{
+    unsigned ii, ss;
+
+    if (clip->cl_loaded) {
+        return clip->cl ? 0 : -1;
+    }
+
+    /* title relative packet position depends on all previous clips */
+    for (ss = 0; ss < clip->title->sub_path_count; ss++) {
+        NAV_CLIP_LIST *list = &clip->title->sub_path[ss].clip_list;
+        if (clip >= list->clip && clip < list->clip + list->count) {
+            uint32_t pos = 0;
+            for (ii = 0; ii < list->count; ii++) {
+                NAV_CLIP *cl = &list->clip[ii];
+                if (!cl->cl_loaded) {
+                    _load_clip(cl);
+                }
+                cl->title_pkt = pos;
+                pos += cl->end_pkt - cl->start_pkt;
+                if (cl == clip) {
+                    break;
+                }
+            }
+            BD_DEBUG(DBG_NAV, "Loaded sub path %u clip %u info (%s)\n", ss, ii, clip->cl ? "ok" : "failed");
+            return clip->cl ? 0 : -1;
+        }
+    }
+
+    return _load_clip(clip);
 }
 
 static
@@ -713,8 +1054,9 @@ void _nav_title_close(NAV_TITLE *title)
         }
         X_FREE(title->clip_list.clip);
     }
+    X_FREE(title->clip_end_pkt);
 
-    mpls_free(&title->pl);
+    mpls_unref(&title->pl);
     X_FREE(title->chap_list.mark);
     X_FREE(title->mark_list.mark);
     X_FREE(title);
@@ -731,9 +1073,7 @@ void nav_title_close(NAV_TITLE **title)
 NAV_TITLE* nav_title_open(BD_DISC *disc, const char *playlist, unsigned angle)
 {
     NAV_TITLE *title = NULL;
-    unsigned ii, ss;
-    uint32_t pos = 0;
-    uint32_t time = 0;
+    unsigned ss;
 
     title = calloc(1, sizeof(NAV_TITLE));
     if (title == NULL) {
@@ -751,30 +1091,20 @@ NAV_TITLE* nav_title_open(BD_DISC *disc, const char *playlist, unsigned angle)
         return NULL;
     }
 
-    // Find length in packets and end_pkt for each clip
     if (title->pl->list_count) {
         title->clip_list.count = title->pl->list_count;
         title->clip_list.clip = calloc(title->pl->list_count, sizeof(NAV_CLIP));
-        if (!title->clip_list.clip) {
+        title->clip_end_pkt = calloc(2 * title->pl->list_count, sizeof(uint32_t));
+        if (!title->clip_list.clip || !title->clip_end_pkt) {
             _nav_title_close(title);
             return NULL;
         }
+        title->clip_end_time = title->clip_end_pkt + title->pl->list_count;
         title->packets = 0;
-        for (ii = 0; ii < title->pl->list_count; ii++) {
-            const MPLS_PI *pi;
-            NAV_CLIP *clip;
-
-            pi = &title->pl->play_item[ii];
-
-            clip = &title->clip_list.clip[ii];
-
-            _fill_clip(title, pi->clip, pi->connection_condition, pi->in_time, pi->out_time, pi->angle_count,
-                       pi->still_mode, pi->still_time, clip, ii, &pos, &time);
-        }
+        _fill_main_clips(title);
     }
 
     // sub paths
-    // Find length in packets and end_pkt for each clip
     if (title->pl->sub_count > 0) {
         title->sub_path_count = title->pl->sub_count;
         title->sub_path       = calloc(title->sub_path_count, sizeof(NAV_SUB_PATH));
@@ -797,14 +1127,7 @@ NAV_TITLE* nav_title_open(BD_DISC *disc, const char *playlist, unsigned angle)
               return NULL;
             }
 
-            pos = time = 0;
-            for (ii = 0; ii < sub_path->clip_list.count; ii++) {
-                const MPLS_SUB_PI *pi   = &title->pl->sub_path[ss].sub_play_item[ii];
-                NAV_CLIP    *clip = &sub_path->clip_list.clip[ii];
-
-                _fill_clip(title, pi->clip, pi->connection_condition, pi->in_time, pi->out_time, 0,
-                           0, 0, clip, ii, &pos, &time);
-            }
+            _fill_sub_clips(title, ss);
         }
     }
 
@@ -850,27 +1173,55 @@ const NAV_CLIP* nav_chapter_search(const NAV_TITLE *title, unsigned chapter,
     return clip;
 }
 
+/* index of first element > value, or count */
+static unsigned _upper_bound(const uint32_t *v, unsigned count, uint32_t value)
+{
+    unsigned lo = 0, hi = count;
+
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+        if (v[mid] > value) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+/* index of first mark with title_pkt > title_pkt, or count */
+static unsigned _mark_upper_bound(const NAV_MARK_LIST *list, uint32_t title_pkt)
+{
+    unsigned lo = 0, hi = list->count;
+
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+        if (list->mark[mid].title_pkt > title_pkt) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
 uint32_t nav_chapter_get_current(const NAV_TITLE * title, uint32_t title_pkt)
 {
-    const NAV_MARK * mark;
-    uint32_t ii;
+    unsigned ii;
 
     if (title == NULL) {
         return 0;
     }
-    for (ii = 0; ii < title->chap_list.count; ii++) {
-        mark = &title->chap_list.mark[ii];
-        if (mark->title_pkt <= title_pkt) {
-            if ( ii == title->chap_list.count - 1 ) {
-                return ii;
-            }
-            mark = &title->chap_list.mark[ii+1];
-            if (mark->title_pkt > title_pkt) {
-                return ii;
-            }
-        }
-    }
-    return 0;
+
+    /* marks are in presentation order */
+    ii = _mark_upper_bound(&title->chap_list, title_pkt);
+    return ii > 0 ? ii - 1 : 0;
+}
+
+int nav_mark_find_next(const NAV_TITLE *title, uint32_t title_pkt)
+{
+    unsigned ii = _mark_upper_bound(&title->mark_list, title_pkt);
+    return ii < title->mark_list.count ? (int)ii : -1;
 }
 
 // Search for random access point closest to the requested packet
@@ -924,31 +1275,23 @@ const NAV_CLIP* nav_packet_search(const NAV_TITLE *title, uint32_t pkt,
                                   uint32_t *clip_pkt, uint32_t *out_pkt, uint32_t *out_time)
 {
     const NAV_CLIP *clip;
-    uint32_t pos, len;
     unsigned ii;
 
     *out_time = 0;
-    pos = 0;
 
     if (title->pl->list_count < 1) {
         BD_DEBUG(DBG_NAV | DBG_CRIT, "nav_packet_search() failed: empty playlist\n");
         return NULL;
     }
 
-    for (ii = 0; ii < title->pl->list_count; ii++) {
-        clip = &title->clip_list.clip[ii];
-        len = clip->end_pkt - clip->start_pkt;
-        if (pkt < pos + len)
-            break;
-        pos += len;
-    }
-    if (ii == title->pl->list_count) {
+    ii = _upper_bound(title->clip_end_pkt, title->clip_list.count, pkt);
+    if (ii == title->clip_list.count) {
         clip = &title->clip_list.clip[ii-1];
         *out_time = clip->duration + clip->in_time;
         *clip_pkt = clip->end_pkt;
     } else {
         clip = &title->clip_list.clip[ii];
-        nav_clip_packet_search(clip, pkt - pos + clip->start_pkt, clip_pkt, out_time);
+        nav_clip_packet_search(clip, pkt - clip->title_pkt + clip->start_pkt, clip_pkt, out_time);
     }
     if(*out_time < clip->in_time)
         *out_time = 0;
@@ -992,9 +1335,7 @@ uint32_t nav_clip_angle_change_search(const NAV_CLIP *clip, uint32_t pkt, uint32
 const NAV_CLIP* nav_time_search(const NAV_TITLE *title, uint32_t tick,
                                 uint32_t *clip_pkt, uint32_t *out_pkt)
 {
-    uint32_t pos, len;
-    const MPLS_PI *pi = NULL;
-    NAV_CLIP *clip;
+    const NAV_CLIP *clip;
     unsigned ii;
 
     if (!title->pl) {
@@ -1006,20 +1347,13 @@ const NAV_CLIP* nav_time_search(const NAV_TITLE *title, uint32_t tick,
         return NULL;
     }
 
-    pos = 0;
-    for (ii = 0; ii < title->pl->list_count; ii++) {
-        pi = &title->pl->play_item[ii];
-        len = pi->out_time - pi->in_time;
-        if (tick < pos + len)
-            break;
-        pos += len;
-    }
-    if (ii == title->pl->list_count) {
+    ii = _upper_bound(title->clip_end_time, title->clip_list.count, tick);
+    if (ii == title->clip_list.count) {
         clip = &title->clip_list.clip[ii-1];
         *clip_pkt = clip->end_pkt;
     } else {
         clip = &title->clip_list.clip[ii];
-        nav_clip_time_search(clip, tick - pos + pi->in_time, clip_pkt, out_pkt);
+        nav_clip_time_search(clip, tick - clip->title_time + clip->in_time, clip_pkt, out_pkt);
     }
     *out_pkt = clip->title_pkt + *clip_pkt - clip->start_pkt;
     return clip;
@@ -1073,10 +1407,6 @@ const NAV_CLIP* nav_next_clip(const NAV_TITLE *title, const NAV_CLIP *clip)
 
 void nav_set_angle(NAV_TITLE *title, unsigned angle)
 {
-    int ii;
-    uint32_t pos = 0;
-    uint32_t time = 0;
-
     if (title == NULL) {
         return;
     }
@@ -1090,18 +1420,8 @@ void nav_set_angle(NAV_TITLE *title, unsigned angle)
     }
 
     title->angle = angle;
-    // Find length in packets and end_pkt for each clip
     title->packets = 0;
-    for (ii = 0; ii < title->pl->list_count; ii++) {
-        const MPLS_PI *pi;
-        NAV_CLIP *cl;
-
-        pi = &title->pl->play_item[ii];
-        cl = &title->clip_list.clip[ii];
-
-        _fill_clip(title, pi->clip, pi->connection_condition, pi->in_time, pi->out_time, pi->angle_count,
-                   pi->still_mode, pi->still_time, cl, ii, &pos, &time);
-    }
+    _fill_main_clips(title);
     _extrapolate_title(title);
 }
 
@@ -88,6 +88,10 @@ struct nav_clip_s
     uint8_t  still_mode;
     uint16_t still_time;
 
+    uint8_t  stc_id;
+    uint8_t  connection_condition;
+
+    uint8_t  cl_loaded;  /* clip info load attempted (sub path clips are loaded on demand) */
     const struct clpi_cl *cl;
 };
 
@@ -120,7 +124,11 @@ struct nav_title_s {
     uint32_t      packets;
     uint32_t      duration;
 
-    MPLS_PL       *pl;
+    /* title relative end position of each main path clip (for binary search) */
+    uint32_t      *clip_end_pkt;
+    uint32_t      *clip_end_time;
+
+    const MPLS_PL *pl;
 };
 
 typedef struct nav_title_info_s NAV_TITLE_INFO;
@@ -152,6 +160,7 @@ BD_PRIVATE NAV_TITLE* nav_title_open(struct bd_disc *disc, const char *playlist,
 BD_PRIVATE void nav_title_close(NAV_TITLE **title);
 
 BD_PRIVATE uint32_t  nav_chapter_get_current(const NAV_TITLE *title, uint32_t title_pkt);
+BD_PRIVATE int       nav_mark_find_next(const NAV_TITLE *title, uint32_t title_pkt); /* first mark after title_pkt, -1 if none */
 BD_PRIVATE void      nav_set_angle(NAV_TITLE *title, unsigned angle);
 
 BD_PRIVATE const NAV_CLIP* nav_next_clip(const NAV_TITLE *title, const NAV_CLIP *clip);
@@ -166,6 +175,8 @@ BD_PRIVATE const NAV_CLIP* nav_mark_search(const NAV_TITLE *title, unsigned mark
 
 /* clip ops */
 
+BD_PRIVATE int nav_clip_load(NAV_CLIP *clip);  /* load sub path clip info. 0 on success. */
+
 BD_PRIVATE uint32_t nav_clip_angle_change_search(const NAV_CLIP *clip, uint32_t pkt, uint32_t *time);
 BD_PRIVATE void nav_clip_time_search(const NAV_CLIP *clip, uint32_t tick, uint32_t *clip_pkt, uint32_t *out_pkt);
 BD_PRIVATE void nav_clip_packet_search(const NAV_CLIP *clip, uint32_t pkt, uint32_t *clip_pkt, uint32_t *clip_time);
@@ -0,0 +1,334 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "title_cache.h"
+
+#include "navigation.h"
+
+#include "disc/disc.h"
+
+#include "file/file.h"
+#include "util/logging.h"
+#include "util/macro.h"
+#include "util/strutl.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Cache file format (little-endian):
+ *
+ *   "BDTC"
+ *   u32 version
+ *   u64 signature
+ *   u32 count
+ *   u32 main_title_idx
+ *   count * { name[10], u32 mpls_id, u32 duration, u32 ref }
+ *   u64 checksum (of all preceding data)
+ */
+
+#define TC_MAGIC       "BDTC"
+#define TC_VERSION     2
+#define TC_HDR_SIZE    (4 + 4 + 8 + 4 + 4)
+#define TC_ENTRY_SIZE  (10 + 4 + 4 + 4)
+#define TC_MAX_TITLES  0xffff
+
+/*
+ * hashing
+ */
+
+static uint64_t _hash_bytes(uint64_t h, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    size_t ii;
+
+    /* FNV-1a */
+    for (ii = 0; ii < len; ii++) {
+        h ^= p[ii];
+        h *= UINT64_C(0x100000001b3);
+    }
+    return h;
+}
+
+static uint64_t _hash_u64(uint64_t h, uint64_t v)
+{
+    uint8_t b[8];
+    unsigned ii;
+
+    for (ii = 0; ii < 8; ii++, v >>= 8) {
+        b[ii] = (uint8_t)v;
+    }
+    return _hash_bytes(h, b, 8);
+}
+
+static uint64_t _hash_str(uint64_t h, const char *s)
+{
+    /* include terminating nul */
+    return s ? _hash_bytes(h, s, strlen(s) + 1) : _hash_u64(h, 0);
+}
+
+/*
+ * Compute signature of everything title list depends on.
+ * File modification times are not available for all file systems
+ * (UDF images, application-provided file systems): hash playlist file contents.
+ * Playlists are small, reading them is cheap compared to building the list.
+ */
+
+static int _signature(BD_DISC *disc, uint32_t flags, uint32_t min_title_length, uint64_t *sig)
+{
+    BD_DIR_H *dir;
+    BD_DIRENT ent;
+    uint64_t  h = UINT64_C(0xcbf29ce484222325);
+    char     *prop;
+    int       res;
+
+    h = _hash_u64(h, TC_VERSION);
+    h = _hash_u64(h, flags);
+    h = _hash_u64(h, min_title_length);
+
+    /* main title guessing uses "known" playlists */
+    prop = disc_property_get(disc, DISC_PROPERTY_MAIN_FEATURE);
+    h = _hash_str(h, prop);
+    X_FREE(prop);
+    prop = disc_property_get(disc, DISC_PROPERTY_PLAYLISTS);
+    h = _hash_str(h, prop);
+    X_FREE(prop);
+
+    /* playlist files, in directory order */
+    dir = disc_open_dir(disc, "BDMV" DIR_SEP "PLAYLIST");
+    if (!dir) {
+        return -1;
+    }
+
+    for (res = dir_read(dir, &ent); !res; res = dir_read(dir, &ent)) {
+        uint8_t *data;
+        size_t   size;
+
+        if (ent.d_name[0] == '.') {
+            continue;
+        }
+
+        size = disc_read_file(disc, "BDMV" DIR_SEP "PLAYLIST", ent.d_name, &data);
+
+        h = _hash_str(h, ent.d_name);
+        h = _hash_u64(h, size);
+        h = _hash_bytes(h, data, size);
+        X_FREE(data);
+    }
+    dir_close(dir);
+
+    *sig = h;
+    return 0;
+}
+
+/*
+ * serialization
+ */
+
+static void _put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+static void _put_u64(uint8_t *p, uint64_t v)
+{
+    _put_u32(p, (uint32_t)v);
+    _put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint32_t _get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t _get_u64(const uint8_t *p)
+{
+    return (uint64_t)_get_u32(p) | ((uint64_t)_get_u32(p + 4) << 32);
+}
+
+static NAV_TITLE_LIST *_load(const char *path, uint64_t sig)
+{
+    NAV_TITLE_LIST *title_list = NULL;
+    BD_FILE_H *fp;
+    uint8_t   *data = NULL;
+    int64_t    size;
+    uint32_t   count, main_idx, ii;
+    const uint8_t *p;
+
+    fp = file_open(path, "rb");
+    if (!fp) {
+        return NULL;
+    }
+
+    size = file_size(fp);
+    if (size < TC_HDR_SIZE + 8 || size > TC_HDR_SIZE + 8 + TC_MAX_TITLES * TC_ENTRY_SIZE) {
+        goto out;
+    }
+
+    data = malloc((size_t)size);
+    if (!data || file_read(fp, data, (size_t)size) != (size_t)size) {
+        goto out;
+    }
+
+    if (memcmp(data, TC_MAGIC, 4) ||
+        _get_u32(data + 4) != TC_VERSION ||
+        _get_u64(data + size - 8) != _hash_bytes(UINT64_C(0xcbf29ce484222325), data, (size_t)size - 8)) {
+        BD_DEBUG(DBG_NAV | DBG_CRIT, "Ignoring invalid title list cache file %s\n", path);
+        goto out;
+    }
+
+    if (_get_u64(data + 8) != sig) {
+        BD_DEBUG(DBG_NAV, "Title list cache %s is outdated\n", path);
+        goto out;
+    }
+
+    count    = _get_u32(data + 16);
+    main_idx = _get_u32(data + 20);
+    if (size != TC_HDR_SIZE + 8 + (int64_t)count * TC_ENTRY_SIZE ||
+        (count > 0 && main_idx >= count)) {
+        goto out;
+    }
+
+    title_list = calloc(1, sizeof(NAV_TITLE_LIST));
+    if (!title_list) {
+        goto out;
+    }
+    /* nav_get_title_list() always allocates title_info */
+    title_list->title_info = calloc(count + 1, sizeof(NAV_TITLE_INFO));
+    if (!title_list->title_info) {
+        X_FREE(title_list);
+        goto out;
+    }
+
+    title_list->count          = count;
+    title_list->main_title_idx = main_idx;
+
+    p = data + TC_HDR_SIZE;
+    for (ii = 0; ii < count; ii++, p += TC_ENTRY_SIZE) {
+        NAV_TITLE_INFO *ti = &title_list->title_info[ii];
+        memcpy(ti->name, p, 10);
+        ti->name[10] = '\0';
+        ti->mpls_id  = _get_u32(p + 10);
+        ti->duration = _get_u32(p + 14);
+        ti->ref      = _get_u32(p + 18);
+    }
+
+    BD_DEBUG(DBG_NAV, "Using cached title list %s (%u titles)\n", path, count);
+
+ out:
+    X_FREE(data);
+    file_close(fp);
+    return title_list;
+}
+
+static void _save(const char *path, uint64_t sig, const NAV_TITLE_LIST *title_list)
+{
+    BD_FILE_H *fp;
+    uint8_t   *data, *p;
+    size_t     size;
+    unsigned   ii;
+
+    if (title_list->count > TC_MAX_TITLES) {
+        return;
+    }
+
+    size = TC_HDR_SIZE + 8 + (size_t)title_list->count * TC_ENTRY_SIZE;
+    data = calloc(1, size);
+    if (!data) {
+        return;
+    }
+
+    memcpy(data, TC_MAGIC, 4);
+    _put_u32(data + 4,  TC_VERSION);
+    _put_u64(data + 8,  sig);
+    _put_u32(data + 16, title_list->count);
+    _put_u32(data + 20, title_list->main_title_idx);
+
+    p = data + TC_HDR_SIZE;
+    for (ii = 0; ii < title_list->count; ii++, p += TC_ENTRY_SIZE) {
+        const NAV_TITLE_INFO *ti = &title_list->title_info[ii];
+        memcpy(p, ti->name, 10);
+        _put_u32(p + 10, ti->mpls_id);
+        _put_u32(p + 14, ti->duration);
+        _put_u32(p + 18, ti->ref);
+    }
+
+    _put_u64(data + size - 8, _hash_bytes(UINT64_C(0xcbf29ce484222325), data, size - 8));
+
+    if (file_mkdirs(path) < 0) {
+        goto out;
+    }
+
+    fp = file_open(path, "wb");
+    if (!fp) {
+        BD_DEBUG(DBG_NAV | DBG_CRIT, "Error creating title list cache file %s\n", path);
+        goto out;
+    }
+
+    if (fp->write(fp, data, (int64_t)size) != (int64_t)size) {
+        BD_DEBUG(DBG_NAV | DBG_CRIT, "Error writing title list cache file %s\n", path);
+        file_close(fp);
+        if (file_unlink(path) < 0) {
+            BD_DEBUG(DBG_FILE, "Error removing title list cache file %s\n", path);
+        }
+        goto out;
+    }
+
+    file_close(fp);
+    BD_DEBUG(DBG_NAV, "Stored title list to %s\n", path);
+
+ out:
+    X_FREE(data);
+}
+
+/*
+ *
+ */
+
+NAV_TITLE_LIST *title_cache_get_title_list(BD_DISC *disc, uint32_t flags, uint32_t min_title_length)
+{
+    NAV_TITLE_LIST *title_list = NULL;
+    uint64_t sig;
+    char    *path, *disc_path;
+
+    /* separate cache file for each set of filtering parameters */
+    disc_path = disc_persistent_path(disc, "titles");
+    path = disc_path ? str_printf("%s-%08x-%u", disc_path, flags, min_title_length) : NULL;
+    X_FREE(disc_path);
+
+    if (!path || _signature(disc, flags, min_title_length, &sig) < 0) {
+        X_FREE(path);
+        return nav_get_title_list(disc, flags, min_title_length);
+    }
+
+    title_list = _load(path, sig);
+    if (!title_list) {
+        title_list = nav_get_title_list(disc, flags, min_title_length);
+        if (title_list) {
+            _save(path, sig, title_list);
+        }
+    }
+
+    X_FREE(path);
+    return title_list;
+}
@@ -0,0 +1,41 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(_TITLE_CACHE_H_)
+#define _TITLE_CACHE_H_
+
+#include "util/attributes.h"
+
+#include <stdint.h>
+
+struct bd_disc;
+struct nav_title_list_s;
+
+/*
+ * Persistent title list cache.
+ *
+ * Same as nav_get_title_list(), but result is stored in cache directory.
+ * Cached list is used when playlist directory (file names and contents)
+ * and "known" main feature properties are unchanged. Each set of filtering
+ * parameters has its own cache file.
+ */
+
+BD_PRIVATE struct nav_title_list_s *title_cache_get_title_list(struct bd_disc *disc, uint32_t flags, uint32_t min_title_length);
+
+#endif // _TITLE_CACHE_H_
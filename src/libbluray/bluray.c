@@ -34,8 +34,10 @@
 #include "util/logging.h"
 #include "util/strutl.h"
 #include "util/mutex.h"
+#include "util/thread.h"
 #include "bdnav/bdid_parse.h"
 #include "bdnav/navigation.h"
+#include "bdnav/title_cache.h"
 #include "bdnav/index_parse.h"
 #include "bdnav/meta_parse.h"
 #include "bdnav/meta_data.h"
@@ -43,12 +45,15 @@
 #include "bdnav/uo_mask.h"
 #include "hdmv/hdmv_vm.h"
 #include "hdmv/mobj_parse.h"
+#include "decoders/argb_compositor.h"
 #include "decoders/graphics_controller.h"
 #include "decoders/hdmv_pids.h"
 #include "decoders/m2ts_filter.h"
+#include "decoders/m2ts_unit.h"
 #include "decoders/overlay.h"
 #include "disc/disc.h"
 #include "disc/enc_info.h"
+#include "disc/readahead.h"
 #include "file/file.h"
 #include "bdj/bdj.h"
 #include "bdj/bdjo_parse.h"
@@ -59,6 +64,9 @@
 #include <string.h>
 
 
+/* max. number of aligned units handled in single read */
+#define BLURAY_READ_MAX_UNITS 256
+
 typedef enum {
     title_undef = 0,
     title_hdmv,
@@ -89,12 +97,21 @@ typedef struct {
     uint8_t         seek_flag;  /* used to fine-tune first read after seek */
 
     M2TS_FILTER    *m2ts_filter;
+
+    /* graphics streams found from units of last read (bit 0: IG, bit 1: PG) */
+    uint8_t         unit_gfx[BLURAY_READ_MAX_UNITS];
+
+    /* next clip opened for read-ahead */
+    BD_FILE_H      *next_fp;
+    char            next_name[11];
+    uint8_t         next_prefetched;  /* OS prefetch hint given for next clip */
 } BD_STREAM;
 
 typedef struct {
     const NAV_CLIP *clip;
-    size_t    clip_size;
-    uint8_t  *buf;
+    uint16_t  pid;
+    size_t    size;   /* bytes in buf (aligned units) */
+    uint8_t  *buf;    /* packets of preloaded pid, NULL if data was decoded while loading */
 } BD_PRELOAD;
 
 struct bluray {
@@ -121,6 +138,29 @@ struct bluray {
     /* buffer for bd_read(): current aligned unit of main stream (st0) */
     uint8_t        int_buf[6144];
 
+    /* main stream (st0) read-ahead */
+    BD_READAHEAD   *readahead;
+    unsigned       readahead_units;
+
+    /* parallel stream decryption */
+    unsigned       decrypt_threads;
+
+    /* memory-mapped I/O for local files */
+    uint8_t        use_mmap;
+
+    /* asynchronous I/O for local stream files */
+    unsigned       async_io_units;
+
+    /* shared cache of decrypted units */
+    unsigned       unit_cache_units;
+
+    /* persistent title list cache */
+    uint8_t        title_cache;
+
+    /* defer disc info (title table, BD-J, metadata) until first use */
+    uint8_t        lazy_disc_info;
+    uint8_t        disc_info_pending;
+
     /* seamless angle change request */
     int            seamless_angle_change;
     uint32_t       angle_change_pkt;
@@ -171,8 +211,20 @@ struct bluray {
     bd_argb_overlay_proc_f argb_overlay_proc;
     BD_ARGB_BUFFER      *argb_buffer;
     BD_MUTEX             argb_buffer_mutex;
+
+    /* HDMV graphics rendered to ARGB overlay */
+    ARGB_COMPOSITOR     *argb_compositor;
 };
 
+/* max. size of main stream read-ahead buffer */
+#define BLURAY_READ_AHEAD_MAX_UNITS 8192
+
+/* max. number of stream decryption threads */
+#define BLURAY_DECRYPT_MAX_THREADS  16
+
+/* max. size of shared decrypted unit cache (1.5 GiB) */
+#define BLURAY_UNIT_CACHE_MAX_UNITS 262144
+
 /* Stream Packet Number = byte offset / 192. Avoid 64-bit division. */
 #define SPN(pos) (((uint32_t)((pos) >> 6)) / 3)
 
@@ -646,6 +698,89 @@ static void _close_m2ts(BD_STREAM *st)
     m2ts_filter_close(&st->m2ts_filter);
 }
 
+static void _close_next_m2ts(BD_STREAM *st)
+{
+    if (st->next_fp != NULL) {
+        file_close(st->next_fp);
+        st->next_fp = NULL;
+    }
+}
+
+static void _close_readahead(BLURAY *bd)
+{
+    _close_next_m2ts(&bd->st0);
+    readahead_free(&bd->readahead);
+}
+
+static BD_FILE_H *_open_readahead_stream(BLURAY *bd, const NAV_CLIP *clip)
+{
+    return disc_open_stream_readahead(bd->disc, clip->name, bd->readahead,
+                                      (int64_t)clip->start_pkt * 192,
+                                      (int64_t)clip->end_pkt * 192);
+}
+
+/* without read-ahead worker, let OS start caching next clip near end of current clip */
+#define NEXT_CLIP_PREFETCH_SIZE (256 * 6144)
+
+static void _prefetch_next_clip(BLURAY *bd, BD_STREAM *st)
+{
+    const NAV_CLIP *next;
+
+    if (st->next_prefetched || bd->readahead) {
+        return;
+    }
+    if (st->clip_block_pos + NEXT_CLIP_PREFETCH_SIZE < (uint64_t)st->clip->end_pkt * 192) {
+        return;
+    }
+
+    st->next_prefetched = 1;
+
+    next = nav_next_clip(st->clip->title, st->clip);
+    if (next) {
+        disc_prefetch_stream(bd->disc, next->name,
+                             (int64_t)next->start_pkt * 192, NEXT_CLIP_PREFETCH_SIZE);
+    }
+}
+
+static BD_FILE_H *_open_main_stream(BLURAY *bd, BD_STREAM *st)
+{
+    const NAV_CLIP *next;
+    BD_FILE_H *fp;
+
+    /* (re-)start read-ahead worker if settings were changed */
+    if (bd->readahead && readahead_num_units(bd->readahead) != bd->readahead_units) {
+        _close_readahead(bd);
+    }
+    if (!bd->readahead && bd->readahead_units) {
+        bd->readahead = readahead_init(bd->readahead_units);
+        if (!bd->readahead) {
+            BD_DEBUG(DBG_BLURAY | DBG_CRIT, "Read-ahead not available\n");
+            bd->readahead_units = 0;
+        }
+    }
+    if (!bd->readahead) {
+        return disc_open_stream(bd->disc, st->clip->name);
+    }
+
+    /* use already buffered clip */
+    if (st->next_fp && !strcmp(st->next_name, st->clip->name)) {
+        fp = st->next_fp;
+        st->next_fp = NULL;
+    } else {
+        _close_next_m2ts(st);
+        fp = _open_readahead_stream(bd, st->clip);
+    }
+
+    /* start buffering next clip */
+    next = nav_next_clip(st->clip->title, st->clip);
+    if (next) {
+        st->next_fp = _open_readahead_stream(bd, next);
+        memcpy(st->next_name, next->name, sizeof(st->next_name));
+    }
+
+    return fp;
+}
+
 static int _open_m2ts(BLURAY *bd, BD_STREAM *st)
 {
     _close_m2ts(st);
@@ -654,13 +789,18 @@ static int _open_m2ts(BLURAY *bd, BD_STREAM *st)
         return 0;
     }
 
-    st->fp = disc_open_stream(bd->disc, st->clip->name);
+    if (st == &bd->st0) {
+        st->fp = _open_main_stream(bd, st);
+    } else {
+        st->fp = disc_open_stream(bd->disc, st->clip->name);
+    }
 
     st->clip_size = 0;
     st->clip_pos = (uint64_t)st->clip->start_pkt * 192;
     st->clip_block_pos = (st->clip_pos / 6144) * 6144;
     st->eof_hit = 0;
     st->encrypted_block_cnt = 0;
+    st->next_prefetched = 0;
 
     if (st->fp) {
         int64_t clip_size = file_size(st->fp);
@@ -707,35 +847,44 @@ static int _open_m2ts(BLURAY *bd, BD_STREAM *st)
     return 0;
 }
 
-static int _validate_unit(BLURAY *bd, BD_STREAM *st, uint8_t *buf)
+static int _unit_ok(const M2TS_UNIT_INFO *info)
 {
     /* Check TP_extra_header Copy_permission_indicator. If != 0, unit may be encrypted. */
     /* Check first sync byte. It should never be encrypted. */
-    if (BD_UNLIKELY(buf[0] & 0xc0 || buf[4] != 0x47)) {
+    if (BD_UNLIKELY((info->cpi & 1) || !(info->sync_ok & 1))) {
 
         /* Check first sync bytes. If not OK, drop unit. */
-        if (buf[4] != 0x47 || buf [4 + 192] != 0x47 || buf[4 + 2*192] != 0x47 || buf[4 + 3*192] != 0x47) {
+        if ((info->sync_ok & 0xf) != 0xf) {
+            return 0;
+        }
+    }
 
-            /* Some streams have Copy_permission_indicator incorrectly set. */
-            /* Check first TS sync byte. If unit is encrypted, first 16 bytes are plain, rest not. */
-            /* not 100% accurate (can be random data too). But the unit is broken anyway ... */
-            if (buf[4] == 0x47) {
+    return 1;
+}
 
-                /* most likely encrypted stream. Check couple of blocks before erroring out. */
-                st->encrypted_block_cnt++;
+static int _validate_unit(BLURAY *bd, BD_STREAM *st, uint8_t *buf, const M2TS_UNIT_INFO *info)
+{
+    if (BD_UNLIKELY(!_unit_ok(info))) {
 
-                if (st->encrypted_block_cnt > 10) {
-                    /* error out */
-                    BD_DEBUG(DBG_BLURAY | DBG_CRIT, "TP header copy permission indicator != 0. Stream seems to be encrypted.\n");
-                    _queue_event(bd, BD_EVENT_ENCRYPTED, BD_ERROR_AACS);
-                    return -1;
-                }
-            }
+        /* Some streams have Copy_permission_indicator incorrectly set. */
+        /* Check first TS sync byte. If unit is encrypted, first 16 bytes are plain, rest not. */
+        /* not 100% accurate (can be random data too). But the unit is broken anyway ... */
+        if (buf[4] == 0x47) {
 
-            /* broken block, ignore it */
-            _queue_event(bd, BD_EVENT_READ_ERROR, 1);
-            return 0;
+            /* most likely encrypted stream. Check couple of blocks before erroring out. */
+            st->encrypted_block_cnt++;
+
+            if (st->encrypted_block_cnt > 10) {
+                /* error out */
+                BD_DEBUG(DBG_BLURAY | DBG_CRIT, "TP header copy permission indicator != 0. Stream seems to be encrypted.\n");
+                _queue_event(bd, BD_EVENT_ENCRYPTED, BD_ERROR_AACS);
+                return -1;
+            }
         }
+
+        /* broken block, ignore it */
+        _queue_event(bd, BD_EVENT_READ_ERROR, 1);
+        return 0;
     }
 
     st->eof_hit = 0;
@@ -743,6 +892,26 @@ static int _validate_unit(BLURAY *bd, BD_STREAM *st, uint8_t *buf)
     return 1;
 }
 
+/* post-process valid unit: filter and locate graphics streams */
+static void _process_unit(BD_STREAM *st, uint8_t *unit, M2TS_UNIT_INFO *info, unsigned idx)
+{
+    if (BD_UNLIKELY(info->sync_ok != 0xffffffff)) {
+        /* broken packets are passed to application as-is */
+        BD_DEBUG(DBG_STREAM | DBG_CRIT, "%u broken packet(s) at %" PRIu64 "\n",
+                 m2ts_unit_num_broken(info), st->clip_block_pos + (uint64_t)idx * 6144);
+    }
+
+    if (st->m2ts_filter) {
+        if (m2ts_filter(st->m2ts_filter, unit, info) < 0) {
+            m2ts_filter_close(&st->m2ts_filter);
+            BD_DEBUG(DBG_BLURAY | DBG_CRIT, "m2ts filter error\n");
+        }
+    }
+
+    st->unit_gfx[idx] = (uint8_t)((st->ig_pid && m2ts_unit_has_pid(info, st->ig_pid)) |
+                                  ((st->pg_pid && m2ts_unit_has_pid(info, st->pg_pid)) << 1));
+}
+
 static int _skip_unit(BLURAY *bd, BD_STREAM *st)
 {
     const size_t len = 6144;
@@ -762,47 +931,93 @@ static int _skip_unit(BLURAY *bd, BD_STREAM *st)
     return 0;
 }
 
-static int _read_block(BLURAY *bd, BD_STREAM *st, uint8_t *buf)
+/*
+ * Read up to num_units aligned units with single read call.
+ * Returns number of valid units stored to buf, 0 on recoverable error (EOF, broken unit)
+ * or -1 on fatal error.
+ * If a broken unit is detected after the first unit, read is cut before it.
+ */
+
+static int _read_blocks(BLURAY *bd, BD_STREAM *st, uint8_t *buf, unsigned num_units)
 {
     const size_t len = 6144;
 
     if (st->fp) {
-        BD_DEBUG(DBG_STREAM, "Reading unit at %" PRIu64 "...\n", st->clip_block_pos);
+        BD_DEBUG(DBG_STREAM, "Reading %u unit(s) at %" PRIu64 "...\n", num_units, st->clip_block_pos);
+
+        if (st == &bd->st0) {
+            _prefetch_next_clip(bd, st);
+        }
 
         if (len + st->clip_block_pos <= st->clip_size) {
             size_t read_len;
 
-            if ((read_len = file_read(st->fp, buf, len))) {
+            if (num_units > BLURAY_READ_MAX_UNITS) {
+                num_units = BLURAY_READ_MAX_UNITS;
+            }
+
+            /* do not read past end of file */
+            if (st->clip_block_pos + (uint64_t)num_units * len > st->clip_size) {
+                num_units = (unsigned)((st->clip_size - st->clip_block_pos) / len);
+            }
+
+            if ((read_len = file_read(st->fp, buf, num_units * len))) {
+                unsigned got = (unsigned)(read_len / len);
+                unsigned ii;
                 int error;
+                M2TS_UNIT_INFO info;
 
-                if (read_len != len) {
-                    BD_DEBUG(DBG_STREAM | DBG_CRIT, "Read %d bytes at %" PRIu64 " ; requested %d !\n", (int)read_len, st->clip_block_pos, (int)len);
-                    return _skip_unit(bd, st);
+                if (read_len != num_units * len) {
+                    BD_DEBUG(DBG_STREAM | DBG_CRIT, "Read %d bytes at %" PRIu64 " ; requested %d !\n", (int)read_len, st->clip_block_pos, (int)(num_units * len));
+                    if (got < 1) {
+                        return _skip_unit(bd, st);
+                    }
                 }
-                st->clip_block_pos += len;
 
-                if ((error = _validate_unit(bd, st, buf)) <= 0) {
+                m2ts_unit_scan(buf, &info);
+
+                if ((error = _validate_unit(bd, st, buf, &info)) <= 0) {
                     /* skip broken unit */
-                    BD_DEBUG(DBG_BLURAY | DBG_CRIT, "Skipping broken unit at %" PRId64 "\n", st->clip_block_pos - len);
+                    BD_DEBUG(DBG_BLURAY | DBG_CRIT, "Skipping broken unit at %" PRId64 "\n", st->clip_block_pos);
+                    st->clip_block_pos += len;
                     st->clip_pos += len;
+                    if (read_len != len && file_seek(st->fp, st->clip_block_pos, SEEK_SET) < 0) {
+                        BD_DEBUG(DBG_BLURAY | DBG_CRIT, "Unable to seek clip %s!\n", st->clip->name);
+                        return -1;
+                    }
                     return error;
                 }
 
-                if (st->m2ts_filter) {
-                    int result = m2ts_filter(st->m2ts_filter, buf);
-                    if (result < 0) {
-                        m2ts_filter_close(&st->m2ts_filter);
-                        BD_DEBUG(DBG_BLURAY | DBG_CRIT, "m2ts filter error\n");
+                for (ii = 0; ii < got; ii++) {
+                    uint8_t *unit = buf + ii * len;
+
+                    /* cut before first broken unit. It is handled in next call. */
+                    if (ii > 0) {
+                        m2ts_unit_scan(unit, &info);
+                        if (BD_UNLIKELY(!_unit_ok(&info))) {
+                            break;
+                        }
+                    }
+
+                    _process_unit(st, unit, &info, ii);
+                }
+
+                st->clip_block_pos += ii * len;
+
+                if (ii * len != read_len) {
+                    if (file_seek(st->fp, st->clip_block_pos, SEEK_SET) < 0) {
+                        BD_DEBUG(DBG_BLURAY | DBG_CRIT, "Unable to seek clip %s!\n", st->clip->name);
+                        return -1;
                     }
                 }
 
-                BD_DEBUG(DBG_STREAM, "Read unit OK!\n");
+                BD_DEBUG(DBG_STREAM, "Read %u unit(s) OK!\n", ii);
 
 #ifdef BLURAY_READ_ERROR_TEST
                 /* simulate broken blocks */
                 if (random() % 1000)
 #else
-                return 1;
+                return (int)ii;
 #endif
             }
 
@@ -832,6 +1047,11 @@ static int _read_block(BLURAY *bd, BD_STREAM *st, uint8_t *buf)
     return -1;
 }
 
+static int _read_block(BLURAY *bd, BD_STREAM *st, uint8_t *buf)
+{
+    return _read_blocks(bd, st, buf, 1);
+}
+
 /*
  * clip preload (BD_PRELOAD)
  */
@@ -842,61 +1062,137 @@ static void _close_preload(BD_PRELOAD *p)
     memset(p, 0, sizeof(*p));
 }
 
-#define PRELOAD_SIZE_LIMIT  (512*1024*1024)  /* do not preload clips larger than 512M */
+#define PRELOAD_SIZE_LIMIT  (512*1024*1024)  /* do not keep more than 512M of preloaded data */
+#define PRELOAD_READ_UNITS  32                   /* aligned units per read call */
+
+/* append packets of given pid to preload buffer */
+static int _preload_filter(BD_PRELOAD *p, size_t *alloc_size, const uint8_t *unit)
+{
+    unsigned ii;
+
+    for (ii = 0; ii < 32; ii++, unit += 192) {
+        uint16_t pid = ((unit[4+1] & 0x1f) << 8) | unit[4+2];
+        if (unit[4] != 0x47 || pid != p->pid) {
+            continue;
+        }
+
+        if (p->size + 192 > *alloc_size) {
+            size_t   new_size = *alloc_size ? *alloc_size * 2 : 32 * 6144;
+            uint8_t *tmp;
+            if (new_size > PRELOAD_SIZE_LIMIT) {
+                BD_DEBUG(DBG_BLURAY | DBG_CRIT, "_preload_m2ts(): too much data for pid 0x%04x\n", p->pid);
+                return -1;
+            }
+            tmp = realloc(p->buf, new_size);
+            if (!tmp) {
+                BD_DEBUG(DBG_BLURAY | DBG_CRIT, "_preload_m2ts(): out of memory\n");
+                return -1;
+            }
+            p->buf      = tmp;
+            *alloc_size = new_size;
+        }
+
+        memcpy(p->buf + p->size, unit, 192);
+        p->size += 192;
+    }
+
+    return 0;
+}
+
+/* pad last unit with null packets */
+static void _preload_pad(BD_PRELOAD *p)
+{
+    while (p->size % 6144) {
+        uint8_t *pkt = p->buf + p->size;
+        memset(pkt, 0xff, 192);
+        pkt[0] = pkt[1] = pkt[2] = pkt[3] = 0;
+        pkt[4] = 0x47;
+        pkt[5] = 0x1f; /* pid 0x1fff */
+        pkt[6] = 0xff;
+        pkt[7] = 0x10; /* payload only */
+        p->size += 192;
+    }
+}
 
-static int _preload_m2ts(BLURAY *bd, BD_PRELOAD *p)
+/*
+ * Read sub path clip and demux packets of p->pid.
+ *  decode == 0: keep packets in p->buf.
+ *  decode != 0: feed data directly to graphics controller, nothing is stored.
+ */
+static int _preload_m2ts(BLURAY *bd, BD_PRELOAD *p, int decode)
 {
     /* setup and open BD_STREAM */
 
     BD_STREAM st;
+    uint8_t  *buf;
+    size_t    alloc_size = 0;
+    uint64_t  total = 0;
 
     memset(&st, 0, sizeof(st));
     st.clip = p->clip;
 
-    if (st.clip_size > PRELOAD_SIZE_LIMIT) {
-        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "_preload_m2ts(): too large clip (%" PRId64 ")\n", st.clip_size);
-        return 0;
-    }
+    X_FREE(p->buf);
+    p->size = 0;
 
     if (!_open_m2ts(bd, &st)) {
         return 0;
     }
 
-    /* allocate buffer */
-    p->clip_size = (size_t)st.clip_size;
-    uint8_t* tmp = (uint8_t*)realloc(p->buf, p->clip_size);
-    if (!tmp) {
+    buf = malloc(PRELOAD_READ_UNITS * 6144);
+    if (!buf) {
         BD_DEBUG(DBG_BLURAY | DBG_CRIT, "_preload_m2ts(): out of memory\n");
         _close_m2ts(&st);
-        _close_preload(p);
         return 0;
     }
 
-    p->buf = tmp;
+    /* read clip and demux on the fly */
 
-    /* read clip to buffer */
+    while (total < (uint64_t)st.clip_size) {
+        unsigned num_units = (unsigned)((st.clip_size - total + 6143) / 6144);
+        int r, ii;
 
-    uint8_t *buf = p->buf;
-    uint8_t *end = p->buf + p->clip_size;
+        if (num_units > PRELOAD_READ_UNITS) {
+            num_units = PRELOAD_READ_UNITS;
+        }
 
-    for (; buf < end; buf += 6144) {
-        if (_read_block(bd, &st, buf) <= 0) {
+        r = _read_blocks(bd, &st, buf, num_units);
+        if (r <= 0) {
             BD_DEBUG(DBG_BLURAY|DBG_CRIT, "_preload_m2ts(): error loading %s at %" PRIu64 "\n",
-                  st.clip->name, (uint64_t)(buf - p->buf));
-            _close_m2ts(&st);
-            _close_preload(p);
-            return 0;
+                  st.clip->name, total);
+            goto error;
         }
+
+        if (decode) {
+            gc_decode_ts(bd->graphics_controller, p->pid, buf, (unsigned)r, -1);
+        } else {
+            for (ii = 0; ii < r; ii++) {
+                if (_preload_filter(p, &alloc_size, buf + ii * 6144) < 0) {
+                    goto error;
+                }
+            }
+        }
+
+        total += (uint64_t)r * 6144;
     }
 
-    /* */
+    if (p->buf) {
+        _preload_pad(p);
+    }
 
-    BD_DEBUG(DBG_BLURAY, "_preload_m2ts(): loaded %" PRIu64 " bytes from %s\n",
-          st.clip_size, st.clip->name);
+    BD_DEBUG(DBG_BLURAY, "_preload_m2ts(): loaded %" PRIu64 " bytes from %s (pid 0x%04x: %" PRIu64 " bytes kept)\n",
+          total, st.clip->name, p->pid, (uint64_t)p->size);
 
+    X_FREE(buf);
     _close_m2ts(&st);
 
     return 1;
+
+ error:
+    X_FREE(buf);
+    _close_m2ts(&st);
+    X_FREE(p->buf);
+    p->size = 0;
+    return 0;
 }
 
 static int64_t _seek_stream(BLURAY *bd, BD_STREAM *st,
@@ -1006,7 +1302,12 @@ static void _check_bdj(BLURAY *bd)
     }
 }
 
-static void _fill_disc_info(BLURAY *bd, BD_ENC_INFO *enc_info)
+/*
+ * enc_info is given when disc is opened.
+ * If defer is set, only basic info (disc type, title count, player profile) is filled.
+ * Rest is filled on first use (_ensure_disc_info()).
+ */
+static void _fill_disc_info(BLURAY *bd, BD_ENC_INFO *enc_info, int defer)
 {
     INDX_ROOT *index = NULL;
 
@@ -1045,6 +1346,8 @@ static void _fill_disc_info(BLURAY *bd, BD_ENC_INFO *enc_info)
     memset(bd->disc_info.bdj_org_id,  0, sizeof(bd->disc_info.bdj_org_id));
     memset(bd->disc_info.bdj_disc_id, 0, sizeof(bd->disc_info.bdj_disc_id));
 
+    bd->disc_info_pending = 0;
+
     if (bd->disc) {
         bd->disc_info.udf_volume_id = disc_volume_id(bd->disc);
         index = indx_get(bd->disc);
@@ -1074,6 +1377,31 @@ static void _fill_disc_info(BLURAY *bd, BD_ENC_INFO *enc_info)
         bd->disc_info.initial_output_mode_preference    = index->app_info.initial_output_mode_preference;
         memcpy(bd->disc_info.provider_data, index->app_info.user_data, sizeof(bd->disc_info.provider_data));
 
+        /* increase player profile and version when 3D or UHD disc is detected */
+
+        if (enc_info) {
+            if (index->indx_version >= ('0' << 24 | '3' << 16 | '0' << 8 | '0')) {
+                BD_DEBUG(DBG_BLURAY, "Detected 4K UltraHD (profile 6) disc\n");
+                /* Switch to UHD profile */
+                psr_init_UHD(bd->regs, 1);
+            }
+            if (((index->indx_version >> 16) & 0xff) == '2') {
+                if (index->app_info.content_exist_flag) {
+                    BD_DEBUG(DBG_BLURAY, "Detected Blu-Ray 3D (profile 5) disc\n");
+                    /* Switch to 3D profile */
+                    psr_init_3D(bd->regs, index->app_info.initial_output_mode_preference, 0);
+                }
+            }
+        }
+
+        if (defer) {
+            /* title count is needed for decryption start event */
+            bd->disc_info.num_titles = index->num_titles;
+            bd->disc_info_pending = 1;
+            indx_free(&index);
+            return;
+        }
+
         /* allocate array for title info */
         BLURAY_TITLE **titles = (BLURAY_TITLE**)array_alloc(index->num_titles + 2, sizeof(BLURAY_TITLE));
         if (!titles) {
@@ -1164,21 +1492,6 @@ static void _fill_disc_info(BLURAY *bd, BD_ENC_INFO *enc_info)
             bd->disc_info.top_menu = titles[0];
         }
 
-        /* increase player profile and version when 3D or UHD disc is detected */
-
-        if (index->indx_version >= ('0' << 24 | '3' << 16 | '0' << 8 | '0')) {
-            BD_DEBUG(DBG_BLURAY, "Detected 4K UltraHD (profile 6) disc\n");
-            /* Switch to UHD profile */
-            psr_init_UHD(bd->regs, 1);
-        }
-        if (((index->indx_version >> 16) & 0xff) == '2') {
-            if (index->app_info.content_exist_flag) {
-                BD_DEBUG(DBG_BLURAY, "Detected Blu-Ray 3D (profile 5) disc\n");
-                /* Switch to 3D profile */
-                psr_init_3D(bd->regs, index->app_info.initial_output_mode_preference, 0);
-            }
-        }
-
         indx_free(&index);
 
         /* populate title names */
@@ -1203,11 +1516,21 @@ static void _fill_disc_info(BLURAY *bd, BD_ENC_INFO *enc_info)
     _check_bdj(bd);
 }
 
+static void _ensure_disc_info(BLURAY *bd)
+{
+    if (bd->disc_info_pending) {
+        BD_DEBUG(DBG_BLURAY, "Filling deferred disc info\n");
+        _fill_disc_info(bd, NULL, 0);
+    }
+}
+
 const BLURAY_DISC_INFO *bd_get_disc_info(BLURAY *bd)
 {
     bd_mutex_lock(&bd->mutex);
     if (!bd->disc) {
-        _fill_disc_info(bd, NULL);
+        _fill_disc_info(bd, NULL, 0);
+    } else {
+        _ensure_disc_info(bd);
     }
     bd_mutex_unlock(&bd->mutex);
     return &bd->disc_info;
@@ -1355,6 +1678,23 @@ void bdpriv_unlock_osd_buffer(BLURAY *bd)
     bd_mutex_unlock(&bd->argb_buffer_mutex);
 }
 
+/*
+ * render HDMV graphics to ARGB overlay
+ */
+static void _argb_compositor_cb(void *handle, const BD_OVERLAY * const ov)
+{
+    BLURAY *bd = (BLURAY *)handle;
+
+    bd_mutex_lock(&bd->argb_buffer_mutex);
+
+    if (bd->argb_overlay_proc) {
+        argb_compositor_overlay(bd->argb_compositor, ov, bd->argb_buffer,
+                                bd->argb_overlay_proc_handle, bd->argb_overlay_proc);
+    }
+
+    bd_mutex_unlock(&bd->argb_buffer_mutex);
+}
+
 /*
  * handle graphics updates from BD-J layer
  */
@@ -1530,7 +1870,7 @@ static int _bd_open(BLURAY *bd,
         return 0;
     }
 
-    bd->disc = disc_open(device_path, p_fs,
+    bd->disc = disc_open(device_path, p_fs, bd->use_mmap,
                          &enc_info, keyfile_path,
                          (void*)bd->regs, (void*)bd_psr_read, (void*)bd_psr_write);
 
@@ -1539,7 +1879,17 @@ static int _bd_open(BLURAY *bd,
         return 0;
     }
 
-    _fill_disc_info(bd, &enc_info);
+    _fill_disc_info(bd, &enc_info, bd->lazy_disc_info);
+
+    if (bd->decrypt_threads) {
+        disc_set_decrypt_threads(bd->disc, bd->decrypt_threads);
+    }
+    if (bd->async_io_units) {
+        disc_set_async_io(bd->disc, bd->async_io_units);
+    }
+    if (bd->unit_cache_units) {
+        disc_set_unit_cache(bd->disc, bd->unit_cache_units);
+    }
 
     bd_mutex_unlock(&bd->mutex);
 
@@ -1607,6 +1957,7 @@ void bd_close(BLURAY *bd)
     _close_bdj(bd);
 
     _close_m2ts(&bd->st0);
+    _close_readahead(bd);
     _close_preload(&bd->st_ig);
     _close_preload(&bd->st_textst);
 
@@ -1616,6 +1967,7 @@ void bd_close(BLURAY *bd)
     hdmv_vm_free(&bd->hdmv_vm);
 
     gc_free(&bd->graphics_controller);
+    argb_compositor_free(&bd->argb_compositor);
     meta_free(&bd->meta);
     sound_free(&bd->sound_effects);
     bd_registers_free(bd->regs);
@@ -1640,17 +1992,11 @@ void bd_close(BLURAY *bd)
 
 static void _find_next_playmark(BLURAY *bd)
 {
-    unsigned ii;
-
-    bd->next_mark = -1;
-    bd->next_mark_pos = (uint64_t)-1;
-    for (ii = 0; ii < bd->title->mark_list.count; ii++) {
-        uint64_t pos = (uint64_t)bd->title->mark_list.mark[ii].title_pkt * 192L;
-        if (pos > bd->s_pos) {
-            bd->next_mark = ii;
-            bd->next_mark_pos = pos;
-            break;
-        }
+    bd->next_mark = nav_mark_find_next(bd->title, SPN(bd->s_pos));
+    if (bd->next_mark >= 0) {
+        bd->next_mark_pos = (uint64_t)bd->title->mark_list.mark[bd->next_mark].title_pkt * 192L;
+    } else {
+        bd->next_mark_pos = (uint64_t)-1;
     }
 
     _update_chapter_psr(bd);
@@ -2028,6 +2374,86 @@ static int64_t _clip_seek_time(BLURAY *bd, uint32_t tick)
     return bd->s_pos;
 }
 
+static void _decode_units(BLURAY *bd, BD_STREAM *st, uint8_t *buf, unsigned num_units)
+{
+    unsigned ii;
+
+    for (ii = 0; ii < num_units; ii++, buf += 6144) {
+        /* skip units without graphics stream packets */
+        if (!st->unit_gfx[ii]) {
+            continue;
+        }
+        if (st->unit_gfx[ii] & 1) {
+            if (gc_decode_ts(bd->graphics_controller, st->ig_pid, buf, 1, -1) > 0) {
+                /* initialize menus */
+                _run_gc(bd, GC_CTRL_INIT_MENU, 0);
+            }
+        }
+        if (st->unit_gfx[ii] & 2) {
+            if (gc_decode_ts(bd->graphics_controller, st->pg_pid, buf, 1, -1) > 0) {
+                /* render subtitles */
+                gc_run(bd->graphics_controller, GC_CTRL_PG_UPDATE, 0, NULL);
+            }
+        }
+    }
+
+    if (bd->st_textst.clip) {
+        _update_textst_timer(bd);
+    }
+}
+
+static int _seamless_angle_change(BLURAY *bd, BD_STREAM *st, uint32_t clip_pkt)
+{
+    if (clip_pkt >= st->clip->end_pkt) {
+        st->clip = nav_next_clip(bd->title, st->clip);
+        if (!_open_m2ts(bd, st)) {
+            return -1;
+        }
+        bd->s_pos = (uint64_t)st->clip->title_pkt * 192L;
+    } else {
+        _change_angle(bd);
+        _clip_seek_time(bd, bd->angle_change_time);
+    }
+    bd->seamless_angle_change = 0;
+
+    return 0;
+}
+
+/* returns 1 when next clip was opened, 0 at still mode or end of title, -1 on error */
+static int _open_next_clip(BLURAY *bd, BD_STREAM *st)
+{
+    // handle still mode clips
+    if (st->clip->still_mode == BLURAY_STILL_INFINITE) {
+        _queue_event(bd, BD_EVENT_STILL_TIME, 0);
+        return 0;
+    }
+    if (st->clip->still_mode == BLURAY_STILL_TIME) {
+        if (bd->event_queue) {
+            _queue_event(bd, BD_EVENT_STILL_TIME, st->clip->still_time);
+            return 0;
+        }
+    }
+
+    // find next clip
+    st->clip = nav_next_clip(bd->title, st->clip);
+    if (st->clip == NULL) {
+        BD_DEBUG(DBG_BLURAY | DBG_STREAM, "End of title\n");
+        _queue_event(bd, BD_EVENT_END_OF_TITLE, 0);
+        bd->end_of_playlist |= 1;
+        return 0;
+    }
+    if (!_open_m2ts(bd, st)) {
+        return -1;
+    }
+
+    if (st->clip->connection == CONNECT_NON_SEAMLESS) {
+        /* application layer demuxer buffers must be reset here */
+        _queue_event(bd, BD_EVENT_DISCONTINUITY, st->clip->in_time);
+    }
+
+    return 1;
+}
+
 static int _bd_read(BLURAY *bd, unsigned char *buf, int len)
 {
     BD_STREAM *st = &bd->st0;
@@ -2041,17 +2467,9 @@ static int _bd_read(BLURAY *bd, unsigned char *buf, int len)
             clip_pkt = SPN(st->clip_pos);
             if (bd->seamless_angle_change) {
                 if (clip_pkt >= bd->angle_change_pkt) {
-                    if (clip_pkt >= st->clip->end_pkt) {
-                        st->clip = nav_next_clip(bd->title, st->clip);
-                        if (!_open_m2ts(bd, st)) {
-                            return -1;
-                        }
-                        bd->s_pos = (uint64_t)st->clip->title_pkt * 192L;
-                    } else {
-                        _change_angle(bd);
-                        _clip_seek_time(bd, bd->angle_change_time);
+                    if (_seamless_angle_change(bd, st, clip_pkt) < 0) {
+                        return -1;
                     }
-                    bd->seamless_angle_change = 0;
                 } else {
                     uint64_t angle_pos;
 
@@ -2061,6 +2479,40 @@ static int _bd_read(BLURAY *bd, unsigned char *buf, int len)
                     }
                 }
             }
+            if (st->int_buf_off == 6144 && size >= 6144 && !st->seek_flag &&
+                st->clip_pos == st->clip_block_pos && SPN(st->clip_pos) < st->clip->end_pkt) {
+
+                // Read whole units directly to caller buffer
+                uint64_t end_pos = (uint64_t)st->clip->end_pkt * 192;
+                unsigned num_units = size / 6144;
+
+                if (num_units > (end_pos - st->clip_pos) / 6144) {
+                    num_units = (unsigned)((end_pos - st->clip_pos) / 6144);
+                }
+
+                if (num_units > 0) {
+                    int r = _read_blocks(bd, st, buf, num_units);
+                    if (r > 0) {
+
+                        _decode_units(bd, st, buf, r);
+
+                        size = r * 6144;
+                        buf += size;
+                        len -= size;
+                        out_len += size;
+                        st->clip_pos += size;
+                        bd->s_pos += size;
+                        continue;
+
+                    } else if (r == 0) {
+                        /* recoverable error (EOF, broken block) */
+                        return out_len;
+                    } else {
+                        /* fatal error */
+                        return -1;
+                    }
+                }
+            }
             if (st->int_buf_off == 6144 || clip_pkt >= st->clip->end_pkt) {
 
                 // Do we need to get the next clip?
@@ -2071,55 +2523,16 @@ static int _bd_read(BLURAY *bd, unsigned char *buf, int len)
                         return out_len;
                     }
 
-                    // handle still mode clips
-                    if (st->clip->still_mode == BLURAY_STILL_INFINITE) {
-                        _queue_event(bd, BD_EVENT_STILL_TIME, 0);
-                        return 0;
-                    }
-                    if (st->clip->still_mode == BLURAY_STILL_TIME) {
-                        if (bd->event_queue) {
-                            _queue_event(bd, BD_EVENT_STILL_TIME, st->clip->still_time);
-                            return 0;
-                        }
-                    }
-
-                    // find next clip
-                    st->clip = nav_next_clip(bd->title, st->clip);
-                    if (st->clip == NULL) {
-                        BD_DEBUG(DBG_BLURAY | DBG_STREAM, "End of title\n");
-                        _queue_event(bd, BD_EVENT_END_OF_TITLE, 0);
-                        bd->end_of_playlist |= 1;
-                        return 0;
-                    }
-                    if (!_open_m2ts(bd, st)) {
-                        return -1;
+                    int r = _open_next_clip(bd, st);
+                    if (r <= 0) {
+                        return r;
                     }
-
-                    if (st->clip->connection == CONNECT_NON_SEAMLESS) {
-                        /* application layer demuxer buffers must be reset here */
-                        _queue_event(bd, BD_EVENT_DISCONTINUITY, st->clip->in_time);
-                    }
-
                 }
 
                 int r = _read_block(bd, st, bd->int_buf);
                 if (r > 0) {
 
-                    if (st->ig_pid > 0) {
-                        if (gc_decode_ts(bd->graphics_controller, st->ig_pid, bd->int_buf, 1, -1) > 0) {
-                            /* initialize menus */
-                            _run_gc(bd, GC_CTRL_INIT_MENU, 0);
-                        }
-                    }
-                    if (st->pg_pid > 0) {
-                        if (gc_decode_ts(bd->graphics_controller, st->pg_pid, bd->int_buf, 1, -1) > 0) {
-                            /* render subtitles */
-                            gc_run(bd->graphics_controller, GC_CTRL_PG_UPDATE, 0, NULL);
-                        }
-                    }
-                    if (bd->st_textst.clip) {
-                        _update_textst_timer(bd);
-                    }
+                    _decode_units(bd, st, bd->int_buf, 1);
 
                     st->int_buf_off = st->clip_pos % 6144;
 
@@ -2210,6 +2623,128 @@ int bd_read(BLURAY *bd, unsigned char *buf, int len)
     return result;
 }
 
+static int _bd_read_units(BLURAY *bd, unsigned char *buf, int len, int *start, int *end)
+{
+    BD_STREAM *st = &bd->st0;
+    unsigned  num_units = (unsigned)len / 6144;
+    uint64_t  block_pos, end_pos;
+    uint32_t  clip_pkt;
+    int       r;
+
+    clip_pkt = SPN(st->clip_pos);
+    if (bd->seamless_angle_change && clip_pkt >= bd->angle_change_pkt) {
+        if (_seamless_angle_change(bd, st, clip_pkt) < 0) {
+            return -1;
+        }
+        clip_pkt = SPN(st->clip_pos);
+    }
+
+    if (clip_pkt >= st->clip->end_pkt) {
+        r = _open_next_clip(bd, st);
+        if (r <= 0) {
+            return r;
+        }
+    }
+
+    /* valid data ends at clip end or at seamless angle change point */
+    end_pos = (uint64_t)st->clip->end_pkt * 192;
+    if (bd->seamless_angle_change) {
+        uint64_t angle_pos = (uint64_t)bd->angle_change_pkt * 192L;
+        if (angle_pos > st->clip_pos && angle_pos < end_pos) {
+            end_pos = angle_pos;
+        }
+    }
+
+    if (st->int_buf_off < 6144) {
+
+        /* rest of the unit from previous bd_read() */
+        memcpy(buf, bd->int_buf, 6144);
+        block_pos = st->clip_block_pos - 6144;
+        r = 1;
+
+    } else {
+
+        block_pos = st->clip_block_pos;
+        if (num_units > (end_pos - block_pos + 6143) / 6144) {
+            num_units = (unsigned)((end_pos - block_pos + 6143) / 6144);
+        }
+
+        r = _read_blocks(bd, st, buf, num_units);
+        if (r <= 0) {
+            /* 0: recoverable error (EOF, broken block), -1: fatal error */
+            return r;
+        }
+
+        _decode_units(bd, st, buf, r);
+    }
+
+    *start = (int)(st->clip_pos - block_pos);
+    *end   = r * 6144;
+    if (block_pos + *end > end_pos) {
+        BD_DEBUG(DBG_STREAM, "cut %d bytes at end of block\n", (int)(block_pos + *end - end_pos));
+        *end = (int)(end_pos - block_pos);
+    }
+
+    /* finetune seek point (avoid skipping PAT/PMT/PCR) */
+    if (BD_UNLIKELY(st->seek_flag)) {
+        st->seek_flag = 0;
+
+        /* rewind if previous packets contain PAT/PMT/PCR */
+        while (*start >= 192 && TS_PID(buf + *start - 192) <= HDMV_PID_PCR) {
+            *start -= 192;
+            bd->s_pos -= 192;
+        }
+    }
+
+    st->clip_pos = block_pos + *end;
+    st->int_buf_off = 6144;
+    bd->s_pos += *end - *start;
+
+    BD_DEBUG(DBG_STREAM, "%d units read OK (data %d-%d)\n", r, *start, *end);
+    return r * 6144;
+}
+
+int bd_read_units(BLURAY *bd, unsigned char *buf, int len, int *start, int *end)
+{
+    BD_STREAM *st = &bd->st0;
+    int result;
+
+    *start = *end = 0;
+
+    if (len < 6144) {
+        BD_DEBUG(DBG_STREAM | DBG_CRIT, "bd_read_units(): buffer too small (%d)\n", len);
+        return -1;
+    }
+
+    bd_mutex_lock(&bd->mutex);
+
+    if (!st->fp) {
+        BD_DEBUG(DBG_STREAM | DBG_CRIT, "bd_read_units(): no valid title selected!\n");
+        result = -1;
+
+    } else if (st->clip == NULL) {
+        // We previously reached the last clip.  Nothing
+        // else to read.
+        _queue_event(bd, BD_EVENT_END_OF_TITLE, 0);
+        bd->end_of_playlist |= 1;
+        result = 0;
+
+    } else {
+        BD_DEBUG(DBG_STREAM, "Reading [%d units] at %" PRIu64 "...\n", len / 6144, bd->s_pos);
+
+        result = _bd_read_units(bd, buf, len, start, end);
+
+        /* mark tracking */
+        if (bd->next_mark >= 0 && bd->s_pos > bd->next_mark_pos) {
+            _playmark_reached(bd);
+        }
+    }
+
+    bd_mutex_unlock(&bd->mutex);
+
+    return result;
+}
+
 int bd_read_skip_still(BLURAY *bd)
 {
     BD_STREAM *st = &bd->st0;
@@ -2278,19 +2813,19 @@ static int _preload_textst_subpath(BLURAY *bd)
     gc_run(bd->graphics_controller, GC_CTRL_PG_RESET, 0, NULL);
 
     bd->st_textst.clip = &bd->title->sub_path[textst_subpath].clip_list.clip[textst_subclip];
-    if (!bd->st_textst.clip->cl) {
+    if (nav_clip_load(&bd->title->sub_path[textst_subpath].clip_list.clip[textst_subclip]) < 0) {
         /* required for fonts */
         BD_DEBUG(DBG_BLURAY | DBG_CRIT, "_preload_textst_subpath(): missing clip data\n");
         return -1;
     }
 
-    if (!_preload_m2ts(bd, &bd->st_textst)) {
+    /* TextST is decoded once: no need to keep the data */
+    bd->st_textst.pid = textst_pid;
+    if (!_preload_m2ts(bd, &bd->st_textst, 1)) {
         _close_preload(&bd->st_textst);
         return 0;
     }
 
-    gc_decode_ts(bd->graphics_controller, textst_pid, bd->st_textst.buf, SPN(bd->st_textst.clip_size) / 32, -1);
-
     /* set fonts and encoding from clip info */
     gc_add_font(bd->graphics_controller, NULL, -1); /* reset fonts */
     for (ii = 0; NULL != (font_file = nav_clip_textst_font(bd->st_textst.clip, ii)); ii++) {
@@ -2362,13 +2897,20 @@ static int _preload_ig_subpath(BLURAY *bd)
         //return 1;
     }
 
+    if (nav_clip_load(&bd->title->sub_path[ig_subpath].clip_list.clip[ig_subclip]) < 0) {
+        BD_DEBUG(DBG_BLURAY | DBG_CRIT, "_preload_ig_subpath(): missing clip data\n");
+        return -1;
+    }
+
     bd->st_ig.clip = &bd->title->sub_path[ig_subpath].clip_list.clip[ig_subclip];
 
     if (bd->title->sub_path[ig_subpath].clip_list.count > 1) {
         BD_DEBUG(DBG_BLURAY | DBG_CRIT, "_preload_ig_subpath(): multi-clip sub paths not supported\n");
     }
 
-    if (!_preload_m2ts(bd, &bd->st_ig)) {
+    /* IG data is re-decoded when menus are initialized */
+    bd->st_ig.pid = ig_pid;
+    if (!_preload_m2ts(bd, &bd->st_ig, 0)) {
         _close_preload(&bd->st_ig);
         return 0;
     }
@@ -2404,7 +2946,17 @@ static int _init_ig_stream(BLURAY *bd)
 
     /* decode already preloaded IG sub-path */
     if (bd->st_ig.clip) {
-        gc_decode_ts(bd->graphics_controller, ig_pid, bd->st_ig.buf, SPN(bd->st_ig.clip_size) / 32, -1);
+        if (bd->st_ig.pid != ig_pid && ig_subpath >= 0) {
+            /* only packets of the preloaded stream were kept */
+            BD_DEBUG(DBG_BLURAY, "IG stream pid changed (0x%04x -> 0x%04x), reloading sub path\n",
+                     bd->st_ig.pid, ig_pid);
+            if (_preload_ig_subpath(bd) <= 0) {
+                return 0;
+            }
+        }
+        if (bd->st_ig.buf) {
+            gc_decode_ts(bd->graphics_controller, ig_pid, bd->st_ig.buf, (unsigned)(bd->st_ig.size / 6144), -1);
+        }
         return 1;
     }
 
@@ -2445,6 +2997,7 @@ static void _close_playlist(BLURAY *bd)
     }
 
     _close_m2ts(&bd->st0);
+    _close_next_m2ts(&bd->st0);
     _close_preload(&bd->st_ig);
     _close_preload(&bd->st_textst);
 
@@ -2747,12 +3300,21 @@ uint32_t bd_get_titles(BLURAY *bd, uint8_t flags, uint32_t min_title_length)
 {
     NAV_TITLE_LIST *title_list;
     uint32_t count;
+    int use_cache;
 
     if (!bd) {
         return 0;
     }
 
-    title_list = nav_get_title_list(bd->disc, flags, min_title_length);
+    bd_mutex_lock(&bd->mutex);
+    use_cache = bd->title_cache;
+    bd_mutex_unlock(&bd->mutex);
+
+    if (use_cache) {
+        title_list = title_cache_get_title_list(bd->disc, flags, min_title_length);
+    } else {
+        title_list = nav_get_title_list(bd->disc, flags, min_title_length);
+    }
     if (!title_list) {
         BD_DEBUG(DBG_BLURAY | DBG_CRIT, "nav_get_title_list(%s) failed\n", disc_root(bd->disc));
         return 0;
@@ -3059,6 +3621,115 @@ int bd_set_player_setting(BLURAY *bd, uint32_t idx, uint32_t value)
         return 1;
     }
 
+    if (idx == BLURAY_PLAYER_SETTING_READ_AHEAD) {
+        if (value > BLURAY_READ_AHEAD_MAX_UNITS) {
+            BD_DEBUG(DBG_BLURAY | DBG_CRIT, "Invalid read-ahead size %u\n", value);
+            return 0;
+        }
+        if (value > 0 && !bd_thread_supported()) {
+            BD_DEBUG(DBG_BLURAY | DBG_CRIT, "Read-ahead not supported (no threads)\n");
+            return 0;
+        }
+
+        /* applied when next clip is opened */
+        bd_mutex_lock(&bd->mutex);
+        bd->readahead_units = value;
+        bd_mutex_unlock(&bd->mutex);
+        return 1;
+    }
+
+    if (idx == BLURAY_PLAYER_SETTING_DECRYPT_THREADS) {
+        if (value > BLURAY_DECRYPT_MAX_THREADS) {
+            BD_DEBUG(DBG_BLURAY | DBG_CRIT, "Invalid number of decrypt threads %u\n", value);
+            return 0;
+        }
+        if (value > 1 && !bd_thread_supported()) {
+            BD_DEBUG(DBG_BLURAY | DBG_CRIT, "Decrypt threads not supported (no threads)\n");
+            return 0;
+        }
+
+        bd_mutex_lock(&bd->mutex);
+        bd->decrypt_threads = value;
+        disc_set_decrypt_threads(bd->disc, value);
+        bd_mutex_unlock(&bd->mutex);
+        return 1;
+    }
+
+    if (idx == BLURAY_PLAYER_SETTING_ASYNC_IO) {
+        if (value > BLURAY_READ_AHEAD_MAX_UNITS) {
+            BD_DEBUG(DBG_BLURAY | DBG_CRIT, "Invalid asynchronous I/O size %u\n", value);
+            return 0;
+        }
+
+        bd_mutex_lock(&bd->mutex);
+        bd->async_io_units = value;
+        disc_set_async_io(bd->disc, value);
+        bd_mutex_unlock(&bd->mutex);
+        return 1;
+    }
+
+    if (idx == BLURAY_PLAYER_SETTING_UNIT_CACHE) {
+        if (value > BLURAY_UNIT_CACHE_MAX_UNITS) {
+            BD_DEBUG(DBG_BLURAY | DBG_CRIT, "Invalid unit cache size %u\n", value);
+            return 0;
+        }
+
+        /* applied when disc is opened */
+        bd_mutex_lock(&bd->mutex);
+        bd->unit_cache_units = value;
+        bd_mutex_unlock(&bd->mutex);
+        return 1;
+    }
+
+    if (idx == BLURAY_PLAYER_SETTING_TITLE_CACHE) {
+        bd_mutex_lock(&bd->mutex);
+        bd->title_cache = !!value;
+        bd_mutex_unlock(&bd->mutex);
+        return 1;
+    }
+
+    if (idx == BLURAY_PLAYER_SETTING_LAZY_DISC_INFO) {
+        /* applied when disc is opened */
+        bd_mutex_lock(&bd->mutex);
+        bd->lazy_disc_info = !!value;
+        bd_mutex_unlock(&bd->mutex);
+        return 1;
+    }
+
+    if (idx == BLURAY_PLAYER_SETTING_ARGB_OVERLAY) {
+        result = 1;
+
+        bd_mutex_lock(&bd->mutex);
+
+        if (!value != !bd->argb_compositor) {
+            /* replaces YUV overlay output */
+            gc_free(&bd->graphics_controller);
+            argb_compositor_free(&bd->argb_compositor);
+
+            if (value) {
+                bd->argb_compositor = argb_compositor_init();
+                if (bd->argb_compositor) {
+                    bd->graphics_controller = gc_init(bd->regs, bd, _argb_compositor_cb);
+                }
+                if (!bd->graphics_controller) {
+                    BD_DEBUG(DBG_BLURAY | DBG_CRIT, "Error enabling ARGB overlay output\n");
+                    argb_compositor_free(&bd->argb_compositor);
+                    result = 0;
+                }
+            }
+        }
+
+        bd_mutex_unlock(&bd->mutex);
+        return result;
+    }
+
+    if (idx == BLURAY_PLAYER_SETTING_MMAP_IO) {
+        bd_mutex_lock(&bd->mutex);
+        bd->use_mmap = !!value;
+        bd_mutex_unlock(&bd->mutex);
+        return 1;
+    }
+
     if (idx == BLURAY_PLAYER_SETTING_UO_RESTRICTION_LEVEL) {
         if (BLURAY_PLAYER_SETTING_UO_RESTRICTION_COMPLIANT < value) {
             BD_DEBUG(DBG_BLURAY | DBG_CRIT, "Invalid UO restriction level\n");
@@ -3228,6 +3899,8 @@ int bd_start_bdj(BLURAY *bd, const char *start_object)
         return 0;
     }
 
+    _ensure_disc_info(bd);
+
     /* first play object ? */
     if (bd->disc_info.first_play_supported) {
         t = bd->disc_info.first_play;
@@ -3529,6 +4202,8 @@ static int _play_hdmv(BLURAY *bd, unsigned id_ref)
 
 static int _play_title(BLURAY *bd, unsigned title)
 {
+    _ensure_disc_info(bd);
+
     if (!bd->disc_info.titles) {
         BD_DEBUG(DBG_BLURAY | DBG_CRIT, "_play_title(#%d): No disc index\n", title);
         return 0;
@@ -4115,6 +4790,7 @@ void bd_register_overlay_proc(BLURAY *bd, void *handle, bd_overlay_proc_f func)
     bd_mutex_lock(&bd->mutex);
 
     gc_free(&bd->graphics_controller);
+    argb_compositor_free(&bd->argb_compositor);
 
     if (func) {
         bd->graphics_controller = gc_init(bd->regs, handle, func);
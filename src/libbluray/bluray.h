@@ -541,6 +541,27 @@ BD_PUBLIC uint32_t bd_get_current_title(BLURAY *bd);
  */
 BD_PUBLIC int bd_read(BLURAY *bd, unsigned char *buf, int len);
 
+/**
+ *
+ *  Read aligned units from currently selected title file, decrypt if possible
+ *
+ *  Whole 6144-byte aligned units are read directly to the application buffer.
+ *  Only data in range [start, end) belongs to the title: first unit may start
+ *  before current position, and last unit may continue after clip end or
+ *  seamless angle change point. Range is always aligned to 192-byte packets.
+ *
+ *  Calls to bd_read() and bd_read_units() can be mixed.
+ *
+ * @param bd  BLURAY object
+ * @param buf buffer to read data into
+ * @param len size of buffer, at least 6144 bytes. Only whole units are read.
+ * @param start offset of first valid byte in buf
+ * @param end offset of first byte after valid data in buf
+ * @return size of data stored to buf (multiple of 6144), -1 if error,
+ *         0 if EOF, in still mode or if playback is waiting for application to handle events (same as bd_read())
+ */
+BD_PUBLIC int bd_read_units(BLURAY *bd, unsigned char *buf, int len, int *start, int *end);
+
 
 /*
  * Playback control functions
@@ -749,6 +770,14 @@ typedef enum {
     BLURAY_PLAYER_SETTING_DECODE_PG            = 0x100, /**< Enable/disable PG (subtitle) decoder. Integer. Default: disabled. */
     BLURAY_PLAYER_SETTING_PERSISTENT_STORAGE   = 0x101, /**< Enable/disable BD-J persistent storage. Integer. Default: enabled. */
     BLURAY_PLAYER_SETTING_UO_RESTRICTION_LEVEL = 0x102, /**< Set User Operations (UO) restriction mask enforcement level. bd_player_setting_uo_restriction_level value. Default: BLURAY_PLAYER_SETTING_UO_RESTRICTION_RELAXED. */
+    BLURAY_PLAYER_SETTING_READ_AHEAD           = 0x103, /**< Number of 6144-byte units buffered ahead of playback position in background thread (0...8192). Setting fails if threads are not supported (Windows before Vista). Integer. Default: 0 (disabled). */
+    BLURAY_PLAYER_SETTING_DECRYPT_THREADS      = 0x104, /**< Number of threads used for AACS stream decryption (0...16). Each additional thread opens its own libaacs handle for the disc. Values above 1 fail if threads are not supported (Windows before Vista). Integer. Default: 0 (decrypt in reading thread). */
+    BLURAY_PLAYER_SETTING_MMAP_IO              = 0x105, /**< Enable/disable memory-mapped I/O for local BDMV folders and disc image files. Network and optical file systems are read normally. I/O error or truncation of a mapped file terminates the process (SIGBUS). Applied when disc is opened. Integer. Default: disabled. */
+    BLURAY_PLAYER_SETTING_ASYNC_IO             = 0x106, /**< Number of 6144-byte units read ahead asynchronously (io_uring) from stream files in local BDMV folders (0...8192). Integer. Default: 0 (disabled). */
+    BLURAY_PLAYER_SETTING_UNIT_CACHE           = 0x107, /**< Size of process-wide cache of decrypted stream data shared by all BLURAY objects (number of 6144-byte units, 0...262144). Applied when disc is opened. Integer. Default: 0 (disabled). */
+    BLURAY_PLAYER_SETTING_TITLE_CACHE          = 0x108, /**< Enable/disable persistent cache of bd_get_titles() results in user cache directory. Integer. Default: disabled. */
+    BLURAY_PLAYER_SETTING_LAZY_DISC_INFO       = 0x109, /**< Defer parsing of title table, BD-J info and disc metadata until bd_get_disc_info() or bd_play() is called. Speeds up opening for playlist-only playback. Applied when disc is opened. Integer. Default: disabled. */
+    BLURAY_PLAYER_SETTING_ARGB_OVERLAY         = 0x10A, /**< Render HDMV graphics (PG, IG and text subtitles) to ARGB overlay (bd_register_argb_overlay_proc()). Only changed areas of the planes are passed to application. Replaces YUV overlay output (bd_register_overlay_proc()). Integer. Default: disabled. */
 
     BLURAY_PLAYER_PERSISTENT_ROOT              = 0x200, /**< Root path to the BD_J persistent storage location. String. */
     BLURAY_PLAYER_CACHE_ROOT                   = 0x201, /**< Root path to the BD_J cache storage location. String. */
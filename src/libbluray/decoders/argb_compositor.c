@@ -0,0 +1,302 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "argb_compositor.h"
+
+#include "overlay.h"
+#include "rle.h"
+
+#include "util/logging.h"
+#include "util/macro.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t *argb;     /* plane frame buffer, stride == w */
+    uint16_t  w, h;
+
+    /* dirty region (inclusive). Empty if x1 < x0. */
+    int       x0, y0, x1, y1;
+} ARGB_PLANE;
+
+struct argb_compositor_s {
+    ARGB_PLANE plane[2];
+};
+
+/*
+ * plane
+ */
+
+static void _dirty_reset(ARGB_PLANE *p)
+{
+    p->x0 = p->w;
+    p->y0 = p->h;
+    p->x1 = -1;
+    p->y1 = -1;
+}
+
+static void _dirty_add(ARGB_PLANE *p, int x0, int y0, int x1, int y1)
+{
+    p->x0 = BD_MIN(p->x0, x0);
+    p->y0 = BD_MIN(p->y0, y0);
+    p->x1 = BD_MAX(p->x1, x1);
+    p->y1 = BD_MAX(p->y1, y1);
+}
+
+/* clip rectangle to plane. Return 0 if nothing is left. */
+static int _clip(const ARGB_PLANE *p, const BD_OVERLAY * const ov, int *w, int *h)
+{
+    if (!p->argb || ov->x >= p->w || ov->y >= p->h) {
+        return 0;
+    }
+    *w = BD_MIN(ov->w, p->w - ov->x);
+    *h = BD_MIN(ov->h, p->h - ov->y);
+    return *w > 0 && *h > 0;
+}
+
+static void _plane_close(ARGB_PLANE *p)
+{
+    X_FREE(p->argb);
+    p->w = p->h = 0;
+    _dirty_reset(p);
+}
+
+static int _plane_init(ARGB_PLANE *p, unsigned w, unsigned h)
+{
+    if (p->argb && p->w == w && p->h == h) {
+        memset(p->argb, 0, (size_t)w * h * sizeof(uint32_t));
+    } else {
+        _plane_close(p);
+        if (w && h) {
+            p->argb = calloc((size_t)w * h, sizeof(uint32_t));
+            if (!p->argb) {
+                BD_DEBUG(DBG_GC | DBG_CRIT, "out of memory\n");
+                return -1;
+            }
+        }
+        p->w = w;
+        p->h = h;
+    }
+
+    _dirty_reset(p);
+    return 0;
+}
+
+static void _plane_wipe(ARGB_PLANE *p, int x, int y, int w, int h)
+{
+    uint32_t *dst = p->argb + y * p->w + x;
+    int yy;
+
+    for (yy = 0; yy < h; yy++, dst += p->w) {
+        memset(dst, 0, w * sizeof(uint32_t));
+    }
+    _dirty_add(p, x, y, x + w - 1, y + h - 1);
+}
+
+static void _plane_draw(ARGB_PLANE *p, const BD_OVERLAY * const ov, int w, int h)
+{
+    uint32_t lut[256];
+
+    if (!ov->img || !ov->palette) {
+        return;
+    }
+
+    /* palette uses the color matrix of the video */
+    rle_palette_to_argb(lut, ov->palette, p->h > 576 ? BD_RLE_DECODE_BT709 : 0);
+    rle_decode_lut(p->argb + ov->y * p->w + ov->x, p->w, ov->img, 0, 0, w, h, lut);
+
+    _dirty_add(p, ov->x, ov->y, ov->x + w - 1, ov->y + h - 1);
+}
+
+/* copy dirty region to application-allocated frame buffer */
+static void _copy_to_buffer(const ARGB_PLANE *p, unsigned plane, BD_ARGB_BUFFER *buf)
+{
+    const uint32_t *src;
+    uint32_t *dst;
+    int x1 = p->x1, y1 = p->y1;
+    int y;
+
+    /* set dirty area before lock() */
+    buf->dirty[plane].x0 = (uint16_t)p->x0;
+    buf->dirty[plane].x1 = (uint16_t)p->x1;
+    buf->dirty[plane].y0 = (uint16_t)p->y0;
+    buf->dirty[plane].y1 = (uint16_t)p->y1;
+
+    if (buf->lock) {
+        buf->lock(buf);
+    }
+
+    if (!buf->buf[plane]) {
+        BD_DEBUG(DBG_GC | DBG_CRIT, "ARGB frame buffer missing\n");
+        goto out;
+    }
+
+    if (buf->width < p->w || buf->height < p->h) {
+        BD_DEBUG(DBG_GC | DBG_CRIT, "ARGB frame buffer (%dx%d) is smaller than plane (%dx%d)\n",
+                 buf->width, buf->height, p->w, p->h);
+        goto out;
+    }
+
+    dst = buf->buf[plane] + p->y0 * buf->width + p->x0;
+
+    src = p->argb + p->y0 * p->w + p->x0;
+    for (y = p->y0; y <= y1; y++) {
+        memcpy(dst, src, (x1 - p->x0 + 1) * sizeof(uint32_t));
+        src += p->w;
+        dst += buf->width;
+    }
+
+ out:
+    if (buf->unlock) {
+        buf->unlock(buf);
+    }
+}
+
+static void _plane_flush(ARGB_PLANE *p, unsigned plane, int64_t pts,
+                         BD_ARGB_BUFFER *buf, void *handle, argb_overlay_proc_f func)
+{
+    BD_ARGB_OVERLAY aov;
+
+    memset(&aov, 0, sizeof(aov));
+    aov.pts   = pts;
+    aov.plane = plane;
+
+    /* pass only changed region */
+    if (p->x1 >= p->x0 && p->y1 >= p->y0) {
+        if (buf) {
+            _copy_to_buffer(p, plane, buf);
+        }
+
+        aov.cmd    = BD_ARGB_OVERLAY_DRAW;
+        aov.x      = p->x0;
+        aov.y      = p->y0;
+        aov.w      = p->x1 - p->x0 + 1;
+        aov.h      = p->y1 - p->y0 + 1;
+        aov.stride = p->w;
+        aov.argb   = p->argb + p->y0 * p->w + p->x0;
+        func(handle, &aov);
+    }
+
+    /* commit changes */
+    aov.cmd = BD_ARGB_OVERLAY_FLUSH;
+    func(handle, &aov);
+
+    if (buf) {
+        /* reset dirty area */
+        buf->dirty[plane].x0 = buf->width;
+        buf->dirty[plane].y0 = buf->height;
+        buf->dirty[plane].x1 = 0;
+        buf->dirty[plane].y1 = 0;
+    }
+    _dirty_reset(p);
+}
+
+/*
+ *
+ */
+
+ARGB_COMPOSITOR *argb_compositor_init(void)
+{
+    return calloc(1, sizeof(ARGB_COMPOSITOR));
+}
+
+void argb_compositor_free(ARGB_COMPOSITOR **pp)
+{
+    if (pp && *pp) {
+        _plane_close(&(*pp)->plane[0]);
+        _plane_close(&(*pp)->plane[1]);
+        X_FREE(*pp);
+    }
+}
+
+void argb_compositor_overlay(ARGB_COMPOSITOR *c, const BD_OVERLAY * const ov,
+                             BD_ARGB_BUFFER *buf, void *handle, argb_overlay_proc_f func)
+{
+    BD_ARGB_OVERLAY aov;
+    ARGB_PLANE     *p;
+    int             w, h;
+
+    if (!c || !ov || ov->plane > BD_OVERLAY_IG) {
+        return;
+    }
+    p = &c->plane[ov->plane];
+
+    switch (ov->cmd) {
+        case BD_OVERLAY_INIT:
+            if (_plane_init(p, ov->w, ov->h) < 0) {
+                break;
+            }
+            memset(&aov, 0, sizeof(aov));
+            aov.cmd   = BD_ARGB_OVERLAY_INIT;
+            aov.pts   = ov->pts;
+            aov.plane = ov->plane;
+            aov.x     = ov->x;
+            aov.y     = ov->y;
+            aov.w     = ov->w;
+            aov.h     = ov->h;
+            func(handle, &aov);
+            break;
+
+        case BD_OVERLAY_CLOSE:
+            _plane_close(p);
+            memset(&aov, 0, sizeof(aov));
+            aov.cmd   = BD_ARGB_OVERLAY_CLOSE;
+            aov.pts   = ov->pts;
+            aov.plane = ov->plane;
+            func(handle, &aov);
+            break;
+
+        case BD_OVERLAY_CLEAR:
+            if (p->argb) {
+                _plane_wipe(p, 0, 0, p->w, p->h);
+            }
+            break;
+
+        case BD_OVERLAY_WIPE:
+            if (_clip(p, ov, &w, &h)) {
+                _plane_wipe(p, ov->x, ov->y, w, h);
+            }
+            break;
+
+        case BD_OVERLAY_DRAW:
+            if (_clip(p, ov, &w, &h)) {
+                _plane_draw(p, ov, w, h);
+            }
+            break;
+
+        case BD_OVERLAY_HIDE:
+            /* plane content is already cleared */
+            break;
+
+        case BD_OVERLAY_FLUSH:
+            if (p->argb) {
+                _plane_flush(p, ov->plane, ov->pts, buf, handle, func);
+            }
+            break;
+
+        default:
+            BD_DEBUG(DBG_GC | DBG_CRIT, "unknown overlay event %d\n", ov->cmd);
+            break;
+    }
+}
@@ -0,0 +1,50 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(_ARGB_COMPOSITOR_H_)
+#define _ARGB_COMPOSITOR_H_
+
+#include "util/attributes.h"
+
+struct bd_overlay_s;
+struct bd_argb_overlay_s;
+struct bd_argb_buffer_s;
+
+/*
+ * Render YUV overlay events (BD_OVERLAY) to ARGB overlay planes.
+ *
+ * PG and IG planes are composited to internal frame buffers.
+ * Changed areas are tracked per plane and only dirty region is
+ * passed to application (ARGB overlay callback / application-allocated
+ * frame buffer) when plane is flushed.
+ */
+
+typedef struct argb_compositor_s ARGB_COMPOSITOR;
+
+typedef void (*argb_overlay_proc_f)(void *, const struct bd_argb_overlay_s * const);
+
+BD_PRIVATE ARGB_COMPOSITOR *argb_compositor_init(void);
+BD_PRIVATE void             argb_compositor_free(ARGB_COMPOSITOR **);
+
+/* process overlay event. buf may be NULL. */
+BD_PRIVATE void argb_compositor_overlay(ARGB_COMPOSITOR *c, const struct bd_overlay_s * const ov,
+                                        struct bd_argb_buffer_s *buf,
+                                        void *handle, argb_overlay_proc_f func);
+
+#endif // _ARGB_COMPOSITOR_H_
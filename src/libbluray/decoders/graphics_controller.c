@@ -596,6 +596,48 @@ static void _render_object(GRAPHICS_CONTROLLER *gc,
     }
 }
 
+/* return new reference to cropped object image */
+static const BD_PG_RLE_ELEM *_crop_object(BD_PG_OBJECT *object, const BD_PG_COMPOSITION_OBJECT *cobj)
+{
+    BD_PG_RLE_ELEM *img;
+
+    if (!object->img ||
+        cobj->crop_w < 1 || cobj->crop_x + cobj->crop_w > object->width ||
+        cobj->crop_h < 1 || cobj->crop_y + cobj->crop_h > object->height) {
+        BD_DEBUG(DBG_GC | DBG_CRIT, "invalid crop region %d,%d %dx%d (object %dx%d)\n",
+                 cobj->crop_x, cobj->crop_y, cobj->crop_w, cobj->crop_h, object->width, object->height);
+        return NULL;
+    }
+
+    /* same crop as in previous frame ? (animations, wipes) */
+    if (object->crop_img &&
+        object->crop_x == cobj->crop_x && object->crop_y == cobj->crop_y &&
+        object->crop_w == cobj->crop_w && object->crop_h == cobj->crop_h) {
+        return refcnt_inc(object->crop_img);
+    }
+
+    if (!object->line_idx) {
+        object->line_idx = rle_line_index(object->img, object->width, object->height);
+    }
+
+    img = rle_crop_object(object->img, object->width,
+                          cobj->crop_x, cobj->crop_y, cobj->crop_w, cobj->crop_h,
+                          object->line_idx);
+    if (!img) {
+        return NULL;
+    }
+
+    /* cache */
+    refcnt_dec(object->crop_img);
+    object->crop_img = refcnt_inc(img);
+    object->crop_x   = cobj->crop_x;
+    object->crop_y   = cobj->crop_y;
+    object->crop_w   = cobj->crop_w;
+    object->crop_h   = cobj->crop_h;
+
+    return img;
+}
+
 static void _render_composition_object(GRAPHICS_CONTROLLER *gc,
                                        int64_t pts, unsigned plane,
                                        BD_PG_COMPOSITION_OBJECT *cobj,
@@ -604,7 +646,7 @@ static void _render_composition_object(GRAPHICS_CONTROLLER *gc,
                                        int palette_update_flag)
 {
     if (gc->overlay_proc) {
-        BD_PG_RLE_ELEM *cropped_img = NULL;
+        const BD_PG_RLE_ELEM *cropped_img = NULL;
         BD_OVERLAY ov = {0};
         ov.cmd     = BD_OVERLAY_DRAW;
         ov.pts     = pts;
@@ -618,8 +660,7 @@ static void _render_composition_object(GRAPHICS_CONTROLLER *gc,
 
         if (cobj->crop_flag) {
             if (cobj->crop_x || cobj->crop_y || cobj->crop_w != object->width) {
-                cropped_img = rle_crop_object(object->img, object->width,
-                                              cobj->crop_x, cobj->crop_y, cobj->crop_w, cobj->crop_h);
+                cropped_img = _crop_object(object, cobj);
                 if (!cropped_img) {
                     BD_DEBUG(DBG_DECODE | DBG_CRIT, "Error cropping PG object\n");
                     return;
@@ -131,7 +131,7 @@ static void _join_fragments(PES_BUFFER *p1, PES_BUFFER *p2, int data_pos)
 }
 
 /* return 1 if segment is ready for decoding, 0 if more data is needed */
-static int _join_segment_fragments(struct pes_buffer_s *p)
+static int _join_segment_fragments(struct pes_buffer_s *p, PES_BUFFER **tail)
 {
     uint8_t type;
     unsigned id_pos = 0, id_len = 3, sd_pos = 6, data_pos = 0;
@@ -181,6 +181,10 @@ static int _join_segment_fragments(struct pes_buffer_s *p)
 
         _join_fragments(p, next, data_pos);
 
+        if (!next->next) {
+            /* removing last buffer from queue */
+            *tail = NULL;
+        }
         pes_buffer_remove(&p, next);
 
         if (sd.last_in_seq) {
@@ -520,7 +524,7 @@ static int _decode_segment(PG_DISPLAY_SET *s, PES_BUFFER *p)
  * mpeg-pes interface
  */
 #define MAX_STC_DTS_DIFF (INT64_C(90000 * 30)) /* 30 seconds */
-static int graphics_processor_decode_pes(PG_DISPLAY_SET **s, PES_BUFFER **p, int64_t stc)
+static int graphics_processor_decode_pes(PG_DISPLAY_SET **s, PES_BUFFER **p, PES_BUFFER **tail, int64_t stc)
 {
     if (!s) {
         return 0;
@@ -549,7 +553,7 @@ static int graphics_processor_decode_pes(PG_DISPLAY_SET **s, PES_BUFFER **p, int
         }
 
         /* all fragments present ? */
-        if (!_join_segment_fragments(*p)) {
+        if (!_join_segment_fragments(*p, tail)) {
             GP_TRACE("splitted segment not complete, waiting for next fragment\n");
             return 0;
         }
@@ -586,12 +590,21 @@ struct graphics_processor_s {
     uint16_t    pid;
     M2TS_DEMUX  *demux;
     PES_BUFFER  *queue;
+    PES_BUFFER  *queue_tail; /* last buffer in queue, NULL if unknown */
+    PES_BUFFER_POOL *pool;
 };
 
 GRAPHICS_PROCESSOR *graphics_processor_init(void)
 {
     GRAPHICS_PROCESSOR *p = calloc(1, sizeof(*p));
 
+    if (p) {
+        p->pool = pes_buffer_pool_init();
+        if (!p->pool) {
+            X_FREE(p);
+        }
+    }
+
     return p;
 }
 
@@ -600,6 +613,7 @@ void graphics_processor_free(GRAPHICS_PROCESSOR **p)
     if (p && *p) {
         m2ts_demux_free(&(*p)->demux);
         pes_buffer_free(&(*p)->queue);
+        pes_buffer_pool_free(&(*p)->pool);
 
         X_FREE(*p);
     }
@@ -616,9 +630,10 @@ int graphics_processor_decode_ts(GRAPHICS_PROCESSOR *p,
     if (pid != p->pid) {
         m2ts_demux_free(&p->demux);
         pes_buffer_free(&p->queue);
+        p->queue_tail = NULL;
     }
     if (!p->demux) {
-        p->demux = m2ts_demux_init(pid);
+        p->demux = m2ts_demux_init(pid, p->pool);
         if (!p->demux) {
             return 0;
         }
@@ -626,12 +641,12 @@ int graphics_processor_decode_ts(GRAPHICS_PROCESSOR *p,
     }
 
     for (ii = 0; ii < num_units; ii++) {
-        pes_buffer_append(&p->queue, m2ts_demux(p->demux, unit));
+        pes_buffer_append(&p->queue, &p->queue_tail, m2ts_demux(p->demux, unit));
         unit += 6144;
     }
 
     if (p->queue) {
-        result = graphics_processor_decode_pes(s, &p->queue, stc);
+        result = graphics_processor_decode_pes(s, &p->queue, &p->queue_tail, stc);
     }
 
     return result;
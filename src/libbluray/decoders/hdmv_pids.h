@@ -26,6 +26,7 @@
 #define HDMV_PID_PAT              0
 #define HDMV_PID_PMT              0x0100
 #define HDMV_PID_PCR              0x1001
+#define HDMV_PID_NULL             0x1fff
 
 /* primary streams */
 
@@ -42,6 +42,7 @@ struct m2ts_demux_s
     uint16_t    pid;
     uint32_t    pes_length;
     PES_BUFFER *buf;
+    PES_BUFFER_POOL *pool;
 };
 
 /*
@@ -70,12 +71,13 @@ void m2ts_demux_reset(M2TS_DEMUX *p)
  *
  */
 
-M2TS_DEMUX *m2ts_demux_init(uint16_t pid)
+M2TS_DEMUX *m2ts_demux_init(uint16_t pid, PES_BUFFER_POOL *pool)
 {
     M2TS_DEMUX *p = calloc(1, sizeof(*p));
 
     if (p) {
-        p->pid = pid;
+        p->pid  = pid;
+        p->pool = pool;
     }
 
     return p;
@@ -189,8 +191,11 @@ static int _parse_pes(PES_BUFFER *p, uint8_t *buf, unsigned len)
 
     result = pes_length + 6 - hdr_len;
 
-    if (_realloc(p, BD_MAX(result, 0x100)) < 0) {
-        return -1;
+    /* buffer may be re-used from pool */
+    if (p->size < (unsigned)BD_MAX(result, 0x100)) {
+        if (_realloc(p, BD_MAX(result, 0x100)) < 0) {
+            return -1;
+        }
     }
 
     p->len = len - hdr_len;
@@ -208,6 +213,7 @@ PES_BUFFER *m2ts_demux(M2TS_DEMUX *p, uint8_t *buf)
 {
     uint8_t   *end = buf + 6144;
     PES_BUFFER *result = NULL;
+    PES_BUFFER *tail = NULL;
 
     if (!buf) {
         return _flush(p);
@@ -248,7 +254,7 @@ PES_BUFFER *m2ts_demux(M2TS_DEMUX *p, uint8_t *buf)
                       p->buf->len, p->pes_length);
                 pes_buffer_free(&p->buf);
             }
-            p->buf = pes_buffer_alloc();
+            p->buf = pes_buffer_alloc(p->pool);
             if (!p->buf) {
                 continue;
             }
@@ -274,7 +280,7 @@ PES_BUFFER *m2ts_demux(M2TS_DEMUX *p, uint8_t *buf)
 
         if (p->buf->len == p->pes_length) {
             M2TS_TRACE("PES complete (%d bytes)\n", p->pes_length);
-            pes_buffer_append(&result, p->buf);
+            pes_buffer_append(&result, &tail, p->buf);
             p->buf = NULL;
         }
     }
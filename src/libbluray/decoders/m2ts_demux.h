@@ -29,9 +29,11 @@
  */
 
 struct pes_buffer_s;
+struct pes_buffer_pool_s;
 typedef struct m2ts_demux_s M2TS_DEMUX;
 
-BD_PRIVATE M2TS_DEMUX *m2ts_demux_init(uint16_t pid);
+/* PES buffers are allocated from pool (can be NULL) */
+BD_PRIVATE M2TS_DEMUX *m2ts_demux_init(uint16_t pid, struct pes_buffer_pool_s *pool);
 BD_PRIVATE void        m2ts_demux_free(M2TS_DEMUX **);
 
 BD_PRIVATE void m2ts_demux_reset(M2TS_DEMUX *);
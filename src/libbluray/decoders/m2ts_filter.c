@@ -257,21 +257,22 @@ static int _filter_es_pts(M2TS_FILTER *p, const uint8_t *buf, uint16_t pid)
     return 0;
 }
 
-static void _wipe_packet(uint8_t *p)
+static void _wipe_packet(uint8_t *p, uint16_t *info_pid)
 {
     /* set pid to 0x1fff (padding) */
     p[4 + 2] = 0xff;
     p[4 + 1] |= 0x1f;
+    *info_pid = HDMV_PID_NULL;
 }
 
-int m2ts_filter(M2TS_FILTER *p, uint8_t *buf)
+int m2ts_filter(M2TS_FILTER *p, uint8_t *buf, M2TS_UNIT_INFO *info)
 {
-    uint8_t *end    = buf + 6144;
     int      result = 0;
+    unsigned ii;
 
-    for (; buf < end; buf += 192) {
+    for (ii = 0; ii < 32; ii++, buf += 192) {
 
-        uint16_t pid = ((buf[4+1] & 0x1f) << 8) | buf[4+2];
+        uint16_t pid = info->pid[ii];
         if (pid == HDMV_PID_PAT) {
             p->pat_seen = 1;
             p->pat_packets = 0;
@@ -281,7 +282,7 @@ int m2ts_filter(M2TS_FILTER *p, uint8_t *buf)
             p->pat_packets--;
             if (!p->pat_seen) {
                 M2TS_TRACE("Wiping pid 0x%04x (inside seek buffer, no PAT)\n", pid);
-                _wipe_packet(buf);
+                _wipe_packet(buf, &info->pid[ii]);
                 continue;
             }
             M2TS_TRACE("NOT Wiping pid 0x%04x (inside seek buffer, PAT seen)\n", pid);
@@ -296,13 +297,12 @@ int m2ts_filter(M2TS_FILTER *p, uint8_t *buf)
         if (!p->pat_seen) {
             /* Wipe packet (pid -> padding stream) */
             M2TS_TRACE("Wiping pid 0x%04x before PAT\n", pid);
-            _wipe_packet(buf);
+            _wipe_packet(buf, &info->pid[ii]);
             continue;
         }
 #endif
         /* payload start indicator ? check ES timestamp */
-        unsigned pusi = buf[4+1] & 0x40;
-        if (pusi) {
+        if (info->pusi & (UINT32_C(1) << ii)) {
             if (_filter_es_pts(p, buf, pid) < 0)
                 return -1;
         }
@@ -310,7 +310,7 @@ int m2ts_filter(M2TS_FILTER *p, uint8_t *buf)
         if (_pid_in_list(p->wipe_pid, pid)) {
             /* Wipe packet (pid -> padding stream) */
             M2TS_TRACE("Wiping pid 0x%04x\n", pid);
-            _wipe_packet(buf);
+            _wipe_packet(buf, &info->pid[ii]);
         }
     }
 
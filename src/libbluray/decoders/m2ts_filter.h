@@ -20,6 +20,8 @@
 #if !defined(_M2TS_FILTER_H_)
 #define _M2TS_FILTER_H_
 
+#include "m2ts_unit.h"
+
 #include "util/attributes.h"
 
 #include <stdint.h>
@@ -43,8 +45,9 @@ BD_PRIVATE void         m2ts_filter_close(M2TS_FILTER **);
  *
  *   - drop packets before PAT in seek buffer
  *
+ *   Unit info is updated for dropped packets.
  */
-BD_PRIVATE int m2ts_filter(M2TS_FILTER *, uint8_t *block);
+BD_PRIVATE int m2ts_filter(M2TS_FILTER *, uint8_t *block, M2TS_UNIT_INFO *info);
 
 /*
  * Notify seek. All streams are discarded until next PUSI.
@@ -0,0 +1,182 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "m2ts_unit.h"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#  define M2TS_UNIT_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON) && !defined(__ARM_BIG_ENDIAN)
+#  include <arm_neon.h>
+#  define M2TS_UNIT_NEON
+#endif
+
+/*
+ * Packet headers are collected to 32-bit words:
+ *   bits  0...7  : TS sync byte
+ *   bits  8...15 : TEI, PUSI, priority, pid[12:8]
+ *   bits 16...23 : pid[7:0]
+ *   bits 24...31 : TP_extra_header first byte (copy_permission_indicator in bits 30-31)
+ */
+
+static void _gather(const uint8_t *unit, uint32_t *w)
+{
+    unsigned ii;
+
+#if defined(M2TS_UNIT_SSE2) || defined(M2TS_UNIT_NEON)
+    /* little-endian: single 64-bit load per packet */
+    for (ii = 0; ii < 32; ii++, unit += 192) {
+        uint64_t v;
+        memcpy(&v, unit, sizeof(v));
+        w[ii] = ((uint32_t)(v >> 32) & 0xffffff) | ((uint32_t)v << 24);
+    }
+#else
+    for (ii = 0; ii < 32; ii++, unit += 192) {
+        w[ii] = (uint32_t)unit[4] | ((uint32_t)unit[5] << 8) | ((uint32_t)unit[6] << 16) | ((uint32_t)unit[0] << 24);
+    }
+#endif
+}
+
+#if defined(M2TS_UNIT_SSE2)
+
+static void _scan(const uint32_t *w, M2TS_UNIT_INFO *info)
+{
+    const __m128i sync_mask = _mm_set1_epi32(0xff);
+    const __m128i sync_val  = _mm_set1_epi32(0x47);
+    const __m128i pusi_mask = _mm_set1_epi32(0x4000);
+    const __m128i cpi_mask  = _mm_set1_epi32((int)0xc0000000);
+    const __m128i pid_hi    = _mm_set1_epi32(0x1f00);
+    const __m128i pid_lo    = _mm_set1_epi32(0xff);
+    const __m128i zero      = _mm_setzero_si128();
+    unsigned ii;
+
+    info->sync_ok = info->pusi = info->cpi = 0;
+
+    for (ii = 0; ii < 32; ii += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(w + ii));
+        __m128i b = _mm_loadu_si128((const __m128i *)(w + ii + 4));
+        __m128i pa, pb;
+        unsigned m;
+
+        m  = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(a, sync_mask), sync_val)));
+        m |= (unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(b, sync_mask), sync_val))) << 4;
+        info->sync_ok |= (uint32_t)m << ii;
+
+        m  = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(a, pusi_mask), pusi_mask)));
+        m |= (unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(b, pusi_mask), pusi_mask))) << 4;
+        info->pusi |= (uint32_t)m << ii;
+
+        m  = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(a, cpi_mask), zero)));
+        m |= (unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(b, cpi_mask), zero))) << 4;
+        info->cpi |= (uint32_t)(~m & 0xff) << ii;
+
+        pa = _mm_or_si128(_mm_and_si128(a, pid_hi), _mm_and_si128(_mm_srli_epi32(a, 16), pid_lo));
+        pb = _mm_or_si128(_mm_and_si128(b, pid_hi), _mm_and_si128(_mm_srli_epi32(b, 16), pid_lo));
+        _mm_storeu_si128((__m128i *)(info->pid + ii), _mm_packs_epi32(pa, pb));
+    }
+}
+
+#elif defined(M2TS_UNIT_NEON)
+
+static unsigned _movemask(uint32x4_t v)
+{
+    static const uint32_t bits[4] = { 1, 2, 4, 8 };
+    return vaddvq_u32(vandq_u32(v, vld1q_u32(bits)));
+}
+
+static void _scan(const uint32_t *w, M2TS_UNIT_INFO *info)
+{
+    const uint32x4_t sync_mask = vdupq_n_u32(0xff);
+    const uint32x4_t sync_val  = vdupq_n_u32(0x47);
+    const uint32x4_t pusi_mask = vdupq_n_u32(0x4000);
+    const uint32x4_t cpi_mask  = vdupq_n_u32(0xc0000000);
+    const uint32x4_t pid_hi    = vdupq_n_u32(0x1f00);
+    const uint32x4_t pid_lo    = vdupq_n_u32(0xff);
+    unsigned ii;
+
+    info->sync_ok = info->pusi = info->cpi = 0;
+
+    for (ii = 0; ii < 32; ii += 4) {
+        uint32x4_t a = vld1q_u32(w + ii);
+
+        info->sync_ok |= _movemask(vceqq_u32(vandq_u32(a, sync_mask), sync_val)) << ii;
+        info->pusi    |= _movemask(vtstq_u32(a, pusi_mask)) << ii;
+        info->cpi     |= _movemask(vtstq_u32(a, cpi_mask)) << ii;
+
+        vst1_u16(info->pid + ii, vmovn_u32(vorrq_u32(vandq_u32(a, pid_hi),
+                                                     vandq_u32(vshrq_n_u32(a, 16), pid_lo))));
+    }
+}
+
+#else
+
+static void _scan(const uint32_t *w, M2TS_UNIT_INFO *info)
+{
+    unsigned ii;
+
+    info->sync_ok = info->pusi = info->cpi = 0;
+
+    for (ii = 0; ii < 32; ii++) {
+        info->sync_ok |= (uint32_t)((w[ii] & 0xff) == 0x47) << ii;
+        info->pusi    |= (uint32_t)!!(w[ii] & 0x4000) << ii;
+        info->cpi     |= (uint32_t)!!(w[ii] & 0xc0000000) << ii;
+        info->pid[ii]  = (uint16_t)((w[ii] & 0x1f00) | ((w[ii] >> 16) & 0xff));
+    }
+}
+
+#endif
+
+void m2ts_unit_scan(const uint8_t *unit, M2TS_UNIT_INFO *info)
+{
+    uint32_t w[32];
+
+    _gather(unit, w);
+    _scan(w, info);
+}
+
+unsigned m2ts_unit_num_broken(const M2TS_UNIT_INFO *info)
+{
+    uint32_t bad = ~info->sync_ok;
+    unsigned count = 0;
+
+    for (; bad; bad &= bad - 1) {
+        count++;
+    }
+
+    return count;
+}
+
+int m2ts_unit_has_pid(const M2TS_UNIT_INFO *info, uint16_t pid)
+{
+    unsigned ii;
+    int      found = 0;
+
+    /* no early exit: let compiler vectorize */
+    for (ii = 0; ii < 32; ii++) {
+        found |= (info->pid[ii] == pid);
+    }
+
+    return found;
+}
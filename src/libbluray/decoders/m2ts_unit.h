@@ -0,0 +1,52 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(_M2TS_UNIT_H_)
+#define _M2TS_UNIT_H_
+
+#include "util/attributes.h"
+
+#include <stdint.h>
+
+/*
+ * Aligned unit (32 BDAV TS packets) header summary.
+ *
+ * Unit is scanned once after reading; later stages
+ * (validation, m2ts filter, graphics stream extraction)
+ * use the summary instead of re-parsing packet headers.
+ *
+ * Bit n of masks refers to packet n.
+ */
+
+typedef struct {
+    uint32_t sync_ok;   /* TS sync byte is valid */
+    uint32_t pusi;      /* payload_unit_start_indicator */
+    uint32_t cpi;       /* TP_extra_header copy_permission_indicator != 0 */
+    uint16_t pid[32];
+} M2TS_UNIT_INFO;
+
+BD_PRIVATE void m2ts_unit_scan(const uint8_t *unit, M2TS_UNIT_INFO *info);
+
+/* number of packets with invalid sync byte. Unit data is not modified. */
+BD_PRIVATE unsigned m2ts_unit_num_broken(const M2TS_UNIT_INFO *info);
+
+/* check if unit contains packets of given pid */
+BD_PRIVATE int m2ts_unit_has_pid(const M2TS_UNIT_INFO *info, uint16_t pid);
+
+#endif // _M2TS_UNIT_H_
@@ -151,6 +151,44 @@ void bd_overlay_free(BD_OVERLAY **pov)
 }
 #endif
 
+/*
+ * RLE image decoding
+ */
+
+/** Flags for bd_rle_decode_argb() */
+#define BD_RLE_DECODE_BT709          0x01  /**< Palette uses BT.709 color matrix (HD video). Default: BT.601. */
+#define BD_RLE_DECODE_PREMULTIPLIED  0x02  /**< Output premultiplied alpha */
+
+/**
+ * Decode RLE-compressed overlay image to ARGB pixels.
+ *
+ * Pixels are native-endian 32-bit words: A << 24 | R << 16 | G << 8 | B.
+ * Only region (crop_x, crop_y, crop_w, crop_h) of the image is decoded.
+ *
+ * @param ov  BD_OVERLAY_DRAW event (img, palette, w, h)
+ * @param dst output buffer, crop_h lines
+ * @param stride output line stride (pixels)
+ * @param flags BD_RLE_DECODE_* flags
+ * @return 0 on success, -1 on error
+ */
+BD_PUBLIC int bd_rle_decode_argb(const BD_OVERLAY *ov, uint32_t *dst, unsigned stride,
+                                 unsigned crop_x, unsigned crop_y, unsigned crop_w, unsigned crop_h,
+                                 unsigned flags);
+
+/**
+ * Decode RLE-compressed overlay image to YUVA pixels.
+ *
+ * Pixels are native-endian 32-bit words: T << 24 | Y << 16 | Cb << 8 | Cr.
+ * Only region (crop_x, crop_y, crop_w, crop_h) of the image is decoded.
+ *
+ * @param ov  BD_OVERLAY_DRAW event (img, palette, w, h)
+ * @param dst output buffer, crop_h lines
+ * @param stride output line stride (pixels)
+ * @return 0 on success, -1 on error
+ */
+BD_PUBLIC int bd_rle_decode_yuva(const BD_OVERLAY *ov, uint32_t *dst, unsigned stride,
+                                 unsigned crop_x, unsigned crop_y, unsigned crop_w, unsigned crop_h);
+
 /**
  * ARGB overlay event type
  */
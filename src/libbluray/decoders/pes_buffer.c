@@ -28,39 +28,115 @@
 #include <stdlib.h>
 #include <string.h>
 
-PES_BUFFER *pes_buffer_alloc(void)
+/* max. number of unused buffers kept in pool */
+#define PES_POOL_MAX_BUFFERS 32
+
+struct pes_buffer_pool_s {
+    PES_BUFFER *free;   /* unused buffers */
+    unsigned    count;  /* number of unused buffers */
+};
+
+/*
+ * pool
+ */
+
+PES_BUFFER_POOL *pes_buffer_pool_init(void)
 {
-    PES_BUFFER *p = calloc(1, sizeof(*p));
+    PES_BUFFER_POOL *pool = calloc(1, sizeof(*pool));
+
+    return pool;
+}
+
+void pes_buffer_pool_free(PES_BUFFER_POOL **pool)
+{
+    if (pool && *pool) {
+        PES_BUFFER *p = (*pool)->free;
+        while (p) {
+            PES_BUFFER *next = p->next;
+            X_FREE(p->buf);
+            X_FREE(p);
+            p = next;
+        }
+        X_FREE(*pool);
+    }
+}
+
+/*
+ *
+ */
+
+PES_BUFFER *pes_buffer_alloc(PES_BUFFER_POOL *pool)
+{
+    PES_BUFFER *p;
+
+    if (pool && pool->free) {
+        p = pool->free;
+        pool->free = p->next;
+        pool->count--;
+
+        /* keep payload buffer */
+        p->len  = 0;
+        p->pts  = 0;
+        p->dts  = 0;
+        p->next = NULL;
+        return p;
+    }
+
+    p = calloc(1, sizeof(*p));
+    if (p) {
+        p->pool = pool;
+    }
 
     return p;
 }
 
+static void _release(PES_BUFFER *p)
+{
+    PES_BUFFER_POOL *pool = p->pool;
+
+    if (pool && pool->count < PES_POOL_MAX_BUFFERS) {
+        p->next = pool->free;
+        pool->free = p;
+        pool->count++;
+        return;
+    }
+
+    X_FREE(p->buf);
+    X_FREE(p);
+}
+
 void pes_buffer_free(PES_BUFFER **p)
 {
     if (p && *p) {
-        if ((*p)->next) {
-            pes_buffer_free(&(*p)->next);
+        PES_BUFFER *buf = *p;
+        *p = NULL;
+        while (buf) {
+            PES_BUFFER *next = buf->next;
+            _release(buf);
+            buf = next;
         }
-        X_FREE ((*p)->buf);
-        X_FREE (*p);
     }
 }
 
-void pes_buffer_append(PES_BUFFER **head, PES_BUFFER *buf)
+void pes_buffer_append(PES_BUFFER **head, PES_BUFFER **tail, PES_BUFFER *buf)
 {
-    if (!head) {
+    PES_BUFFER *last;
+
+    if (!head || !buf) {
         return;
     }
 
     if (!*head) {
         *head = buf;
-        return;
+    } else {
+        last = (tail && *tail) ? *tail : *head;
+        for (; last->next; last = last->next) ;
+        last->next = buf;
     }
 
-    if (buf) {
-        PES_BUFFER *tail = *head;
-        for (; tail->next; tail = tail->next) ;
-        tail->next = buf;
+    if (tail) {
+        for (last = buf; last->next; last = last->next) ;
+        *tail = last;
     }
 }
 
@@ -26,6 +26,8 @@
 
 
 typedef struct pes_buffer_s PES_BUFFER;
+typedef struct pes_buffer_pool_s PES_BUFFER_POOL;
+
 struct pes_buffer_s {
     uint8_t  *buf;
     uint32_t  len;  // payload length
@@ -34,14 +36,23 @@ struct pes_buffer_s {
     int64_t   pts;
     int64_t   dts;
 
+    PES_BUFFER_POOL     *pool; // owner pool (NULL if not pooled)
     struct pes_buffer_s *next;
 };
 
 
-BD_PRIVATE PES_BUFFER *pes_buffer_alloc(void) BD_ATTR_MALLOC;
+/*
+ * Released buffers (and their payload memory) are kept in pool for re-use.
+ * All buffers allocated from pool must be released before pool is freed.
+ */
+
+BD_PRIVATE PES_BUFFER_POOL *pes_buffer_pool_init(void);
+BD_PRIVATE void             pes_buffer_pool_free(PES_BUFFER_POOL **);
+
+BD_PRIVATE PES_BUFFER *pes_buffer_alloc(PES_BUFFER_POOL *pool); // pool may be NULL
 BD_PRIVATE void        pes_buffer_free(PES_BUFFER **); // free list of buffers
 
-BD_PRIVATE void        pes_buffer_append(PES_BUFFER **head, PES_BUFFER *buf); // append buf to list
+BD_PRIVATE void        pes_buffer_append(PES_BUFFER **head, PES_BUFFER **tail, PES_BUFFER *buf); // append buf (list) to list. tail (optional): last buffer of list or NULL if unknown, updated
 BD_PRIVATE void        pes_buffer_remove(PES_BUFFER **head, PES_BUFFER *buf); // remove buf from list and free it
 
 BD_PRIVATE void        pes_buffer_next(PES_BUFFER **head); // free first buffer and advance head to next buffer
@@ -83,6 +83,16 @@ typedef struct {
 
     BD_PG_RLE_ELEM *img;
 
+    /* first element of each line in img (built on demand) */
+    uint32_t       *line_idx;
+
+    /* last cropped image */
+    const BD_PG_RLE_ELEM *crop_img;
+    uint16_t        crop_x;
+    uint16_t        crop_y;
+    uint16_t        crop_w;
+    uint16_t        crop_h;
+
 } BD_PG_OBJECT;
 
 typedef struct {
@@ -28,6 +28,7 @@
 #include "util/logging.h"
 #include "util/bits.h"
 
+#include <inttypes.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -119,78 +120,175 @@ int pg_decode_palette(BITBUFFER *bb, BD_PG_PALETTE *p)
     return pg_decode_palette_update(bb, p);
 }
 
-static int _decode_rle(BITBUFFER *bb, BD_PG_OBJECT *p)
-{
-    BD_PG_RLE_ELEM *tmp;
-    int pixels_left = p->width * p->height;
-    int num_rle     = 0;
-    int rle_size    = p->width * p->height / 4;
-
-    if (rle_size < 1)
-        rle_size = 1;
+/*
+ * RLE codes (after 0x00 byte), selected by two high bits of next byte:
+ *   00LLLLLL                     transparent, length 0...63 (0 = end of line)
+ *   01LLLLLL LLLLLLLL            transparent, length 0...16383
+ *   10LLLLLL CCCCCCCC            color C, length 0...63
+ *   11LLLLLL LLLLLLLL CCCCCCCC   color C, length 0...16383
+ * Any other byte is a single pixel of that color.
+ *
+ * Fields are extracted from 32-bit big-endian word starting at 0x00 byte.
+ */
 
-    tmp = refcnt_realloc(p->img, rle_size * sizeof(BD_PG_RLE_ELEM), NULL);
-    if (!tmp) {
-        BD_DEBUG(DBG_DECODE | DBG_CRIT, "pg_decode_object(): realloc failed\n");
-        return 0;
-    }
-    p->img = tmp;
+static const struct {
+    uint8_t  size;        /* code size (bytes) */
+    uint8_t  len_shift;
+    uint16_t len_mask;
+    uint8_t  color_mask;
+} _rle_code[4] = {
+    { 2, 16, 0x003f, 0x00 },
+    { 3,  8, 0x3fff, 0x00 },
+    { 3, 16, 0x003f, 0xff },
+    { 4,  8, 0x3fff, 0xff },
+};
+
+int pg_decode_rle(const uint8_t *data, size_t size, BD_PG_RLE_ELEM *img, size_t max_elem,
+                  unsigned width, unsigned height)
+{
+    const uint8_t *p   = data;
+    const uint8_t *end = data + size;
+    int64_t  pixels_left = (int64_t)width * height;
+    int64_t  line_pixels = 0;  /* pixels in current line */
+    size_t   num_rle     = 0;
+    unsigned num_lines   = 0;
+
+    while (p < end) {
+        uint32_t v;
+        unsigned code;
+
+        if (BD_UNLIKELY(num_rle >= max_elem)) {
+            BD_DEBUG(DBG_DECODE, "pg_decode_rle(): output buffer too small\n");
+            return -1;
+        }
 
-    while (!bb_eof(bb)) {
-        uint32_t len   = 1;
-        uint8_t  color = 0;
-
-        if (!(color = bb_read(bb, 8))) {
-            if (!bb_read(bb, 1)) {
-                if (!bb_read(bb, 1)) {
-                    len = bb_read(bb, 6);
-                } else {
-                    len = bb_read(bb, 14);
-                }
+        if (BD_LIKELY(p[0])) {
+            /* single pixel */
+            img[num_rle].len   = 1;
+            img[num_rle].color = p[0];
+            p++;
+            pixels_left--;
+            line_pixels++;
+
+        } else {
+            if (BD_LIKELY(end - p >= 4)) {
+                v = ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
             } else {
-                if (!bb_read(bb, 1)) {
-                    len = bb_read(bb, 6);
-                } else {
-                    len = bb_read(bb, 14);
-                }
-                color = bb_read(bb, 8);
+                v = ((uint32_t)(end - p > 1 ? p[1] : 0) << 16) | ((uint32_t)(end - p > 2 ? p[2] : 0) << 8);
             }
-        }
 
-        p->img[num_rle].len   = len;
-        p->img[num_rle].color = color;
-
-        pixels_left -= len;
+            code = v >> 22;
+            if (BD_UNLIKELY(end - p < _rle_code[code].size)) {
+                BD_DEBUG(DBG_DECODE, "pg_decode_rle(): truncated data\n");
+                return -1;
+            }
+            p += _rle_code[code].size;
+
+            img[num_rle].len   = (v >> _rle_code[code].len_shift) & _rle_code[code].len_mask;
+            /* color is always in the last byte of the code */
+            img[num_rle].color = (v >> (8 * (4 - _rle_code[code].size))) & _rle_code[code].color_mask;
+            pixels_left -= img[num_rle].len;
+            line_pixels += img[num_rle].len;
+            if (!img[num_rle].len) {
+                /* end of line */
+                num_lines++;
+                line_pixels = 0;
+            }
+        }
 
-        if (pixels_left < 0) {
-            BD_DEBUG(DBG_DECODE, "pg_decode_object(): too many pixels (%d)\n", -pixels_left);
-            return 0;
+        if (BD_UNLIKELY(pixels_left < 0)) {
+            BD_DEBUG(DBG_DECODE, "pg_decode_rle(): too many pixels (%" PRId64 ")\n", -pixels_left);
+            return -1;
         }
 
         num_rle++;
-        if (num_rle >= rle_size) {
-            rle_size *= 2;
-            tmp = refcnt_realloc(p->img, rle_size * sizeof(BD_PG_RLE_ELEM), NULL);
-            if (!tmp) {
-                BD_DEBUG(DBG_DECODE | DBG_CRIT, "pg_decode_object(): realloc failed\n");
-                return 0;
+    }
+
+    /* decoders expect each line to be terminated.
+     * Some discs omit the last end of line marker(s): pad with transparent lines. */
+    if (num_lines < height) {
+        BD_DEBUG(DBG_DECODE, "pg_decode_rle(): missing end of line markers (%u/%u), padding image\n", num_lines, height);
+
+        while (num_lines < height) {
+            int64_t pad = BD_MIN(pixels_left, BD_MAX((int64_t)width - line_pixels, 0));
+
+            if (BD_UNLIKELY(num_rle + 2 > max_elem)) {
+                BD_DEBUG(DBG_DECODE, "pg_decode_rle(): output buffer too small\n");
+                return -1;
             }
-            p->img = tmp;
+            if (pad > 0) {
+                img[num_rle].len   = (uint16_t)pad;
+                img[num_rle].color = 0xff;
+                num_rle++;
+                pixels_left -= pad;
+            }
+            img[num_rle].len   = 0;
+            img[num_rle].color = 0;
+            num_rle++;
+            num_lines++;
+            line_pixels = 0;
         }
     }
 
     if (pixels_left > 0) {
-        BD_DEBUG(DBG_DECODE, "pg_decode_object(): missing %d pixels\n", pixels_left);
+        BD_DEBUG(DBG_DECODE, "pg_decode_rle(): missing %" PRId64 " pixels\n", pixels_left);
+        return -1;
+    }
+
+    return (int)num_rle;
+}
+
+static int _decode_rle(BITBUFFER *bb, BD_PG_OBJECT *p)
+{
+    BD_PG_RLE_ELEM *tmp;
+    size_t size = bb->p_end - bb->p;
+    size_t max_elem;
+    int    num_rle;
+
+    /* each code is at least one byte and at least one pixel or end of line.
+     * Missing lines may be padded with two elements per line. */
+    max_elem = BD_MIN(size, (size_t)p->width * p->height + p->height) + 2 * (size_t)p->height;
+    if (max_elem < 1)
+        max_elem = 1;
+
+    tmp = refcnt_realloc(p->img, max_elem * sizeof(BD_PG_RLE_ELEM), NULL);
+    if (!tmp) {
+        BD_DEBUG(DBG_DECODE | DBG_CRIT, "pg_decode_object(): realloc failed\n");
         return 0;
     }
+    p->img = tmp;
+
+    num_rle = pg_decode_rle(bb->p, size, p->img, max_elem, p->width, p->height);
+    bb->p += size;
+    if (num_rle < 0) {
+        return 0;
+    }
+
+    /* release unused space */
+    if ((size_t)num_rle < max_elem / 2) {
+        tmp = refcnt_realloc(p->img, num_rle * sizeof(BD_PG_RLE_ELEM), NULL);
+        if (tmp) {
+            p->img = tmp;
+        }
+    }
 
     return 1;
 }
 
+static void _clean_object_cache(BD_PG_OBJECT *p)
+{
+    X_FREE(p->line_idx);
+    bd_refcnt_dec(p->crop_img);
+    p->crop_img = NULL;
+}
+
 int pg_decode_object(BITBUFFER *bb, BD_PG_OBJECT *p)
 {
     BD_PG_SEQUENCE_DESCRIPTOR sd;
 
+    /* image is replaced */
+    _clean_object_cache(p);
+
     p->id      = bb_read(bb, 16);
     p->version = bb_read(bb, 8);
 
@@ -275,6 +373,7 @@ int pg_decode_windows(BITBUFFER *bb, BD_PG_WINDOWS *p)
 void pg_clean_object(BD_PG_OBJECT *p)
 {
     if (p) {
+        _clean_object_cache(p);
         bd_refcnt_dec(p->img);
         p->img = NULL;
     }
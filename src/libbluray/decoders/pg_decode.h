@@ -46,6 +46,12 @@ BD_PRIVATE int pg_decode_object(BITBUFFER *bb, BD_PG_OBJECT *p);
 BD_PRIVATE int pg_decode_composition(BITBUFFER *bb, BD_PG_COMPOSITION *p);
 BD_PRIVATE int pg_decode_windows(BITBUFFER *bb, BD_PG_WINDOWS *p);
 
+/* decode object RLE data to caller-provided buffer. Return number of elements or -1.
+ * Image is rejected unless it has width * height pixels. Missing end of line markers
+ * (and pixels of missing lines) are padded with transparent (0xff) pixels. */
+BD_PRIVATE int pg_decode_rle(const uint8_t *data, size_t size, BD_PG_RLE_ELEM *img, size_t max_elem,
+                             unsigned width, unsigned height);
+
 /*
  * cleanup
  */
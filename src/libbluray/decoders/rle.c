@@ -25,6 +25,20 @@
 
 #include "util/logging.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#  define RLE_AVX2
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#  define RLE_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define RLE_NEON
+#endif
+
 /*
  * util
  */
@@ -75,8 +89,47 @@ static int _enc_eol(RLE_ENC *p)
     return _enc_elem(p, 0, 0);
 }
 
+static const BD_PG_RLE_ELEM *_skip_line(const BD_PG_RLE_ELEM *p, int width)
+{
+    int x;
+
+    for (x = 0; x < width; x += p->len, p++) ;
+
+    if (BD_LIKELY(!p->len)) {
+        /* skip eol marker */
+        p++;
+    }
+    return p;
+}
+
+uint32_t *rle_line_index(const BD_PG_RLE_ELEM *img, int width, int height)
+{
+    const BD_PG_RLE_ELEM *p = img;
+    uint32_t *idx;
+    int y;
+
+    if (!img || height < 1) {
+        return NULL;
+    }
+
+    idx = malloc(height * sizeof(uint32_t));
+    if (!idx) {
+        return NULL;
+    }
+
+    for (y = 0; y < height; y++) {
+        idx[y] = (uint32_t)(p - img);
+        if (y + 1 < height) {
+            p = _skip_line(p, width);
+        }
+    }
+
+    return idx;
+}
+
 BD_PG_RLE_ELEM *rle_crop_object(const BD_PG_RLE_ELEM *orig, int width,
-                                int crop_x, int crop_y, int crop_w, int crop_h)
+                                int crop_x, int crop_y, int crop_w, int crop_h,
+                                const uint32_t *line_idx)
 {
     RLE_ENC  rle;
     int      x0 = crop_x;
@@ -88,8 +141,12 @@ BD_PG_RLE_ELEM *rle_crop_object(const BD_PG_RLE_ELEM *orig, int width,
     }
 
     /* skip crop_y */
-    for (y = 0; y < crop_y; y++) {
-        for (x = 0; x < width; x += orig->len, orig++) ;
+    if (line_idx) {
+        orig += line_idx[crop_y];
+    } else {
+        for (y = 0; y < crop_y; y++) {
+            orig = _skip_line(orig, width);
+        }
     }
 
     /* crop lines */
@@ -104,7 +161,7 @@ BD_PG_RLE_ELEM *rle_crop_object(const BD_PG_RLE_ELEM *orig, int width,
             }
 
             /* starts outside, ends outside */
-            if (x + bite.len < x0 || x >= x1) {
+            if (x + bite.len <= x0 || x >= x1) {
                 x += bite.len;
                 continue;
             }
@@ -205,3 +262,201 @@ int rle_compress_chunk(RLE_ENC *p, const uint8_t *mem, unsigned width)
     }
     return 0;
 }
+
+/*
+ * palette
+ */
+
+static uint8_t _clip_u8(int v)
+{
+    return v < 0 ? 0 : v > 255 ? 255 : (uint8_t)v;
+}
+
+static uint8_t _premultiply(uint8_t c, uint8_t a)
+{
+    return (uint8_t)((c * a + 127) / 255);
+}
+
+void rle_palette_to_argb(uint32_t *lut, const BD_PG_PALETTE_ENTRY *pal, unsigned flags)
+{
+    /* 16.16 fixed point coefficients, limited range input */
+    const int bt709 = !!(flags & BD_RLE_DECODE_BT709);
+    const int cy  = 76309;
+    const int crr = bt709 ? 117489 : 104597;
+    const int cbg = bt709 ? -13954 : -25675;
+    const int crg = bt709 ? -34925 : -53279;
+    const int cbb = bt709 ? 138438 : 132201;
+    unsigned ii;
+
+    for (ii = 0; ii < 256; ii++) {
+        uint8_t r, g, b, a = pal[ii].T;
+        int y, cb, cr;
+
+        if (!a) {
+            lut[ii] = 0;
+            continue;
+        }
+
+        y  = cy * (pal[ii].Y - 16) + (1 << 15);
+        cb = pal[ii].Cb - 128;
+        cr = pal[ii].Cr - 128;
+
+        r = _clip_u8((y + crr * cr) >> 16);
+        g = _clip_u8((y + cbg * cb + crg * cr) >> 16);
+        b = _clip_u8((y + cbb * cb) >> 16);
+
+        if (flags & BD_RLE_DECODE_PREMULTIPLIED) {
+            r = _premultiply(r, a);
+            g = _premultiply(g, a);
+            b = _premultiply(b, a);
+        }
+
+        lut[ii] = ((uint32_t)a << 24) | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+}
+
+void rle_palette_to_yuva(uint32_t *lut, const BD_PG_PALETTE_ENTRY *pal)
+{
+    unsigned ii;
+
+    for (ii = 0; ii < 256; ii++) {
+        lut[ii] = ((uint32_t)pal[ii].T << 24) | ((uint32_t)pal[ii].Y << 16) | ((uint32_t)pal[ii].Cb << 8) | pal[ii].Cr;
+    }
+}
+
+/*
+ * decompress
+ */
+
+static void _fill(uint32_t *dst, uint32_t v, unsigned n)
+{
+    /* long runs of transparent (or other byte-repeating) color */
+    if (n >= 16 && (v & 0xff) * 0x01010101u == v) {
+        memset(dst, (int)(v & 0xff), n * sizeof(uint32_t));
+        return;
+    }
+
+#if defined(RLE_AVX2)
+    if (n >= 8) {
+        const __m256i x = _mm256_set1_epi32((int)v);
+        for (; n >= 8; n -= 8, dst += 8) {
+            _mm256_storeu_si256((__m256i *)dst, x);
+        }
+    }
+#elif defined(RLE_SSE2)
+    if (n >= 4) {
+        const __m128i x = _mm_set1_epi32((int)v);
+        for (; n >= 4; n -= 4, dst += 4) {
+            _mm_storeu_si128((__m128i *)dst, x);
+        }
+    }
+#elif defined(RLE_NEON)
+    if (n >= 4) {
+        const uint32x4_t x = vdupq_n_u32(v);
+        for (; n >= 4; n -= 4, dst += 4) {
+            vst1q_u32(dst, x);
+        }
+    }
+#endif
+
+    while (n--) {
+        *dst++ = v;
+    }
+}
+
+void rle_decode_lut(uint32_t *dst, unsigned dst_stride, const BD_PG_RLE_ELEM *img,
+                    unsigned crop_x, unsigned crop_y, unsigned crop_w, unsigned crop_h,
+                    const uint32_t *lut)
+{
+    const unsigned x1 = crop_x + crop_w; /* first pixel outside of cropped region */
+    unsigned y;
+
+    if (!img) {
+        return;
+    }
+
+    /* skip crop_y */
+    for (y = 0; y < crop_y; y++) {
+        while (img->len) {
+            img++;
+        }
+        img++;
+    }
+
+    for (y = 0; y < crop_h; y++, dst += dst_stride) {
+        unsigned x = 0;
+
+        /* expand one line */
+        for (; img->len; img++) {
+            unsigned start = x;
+            unsigned end   = x + img->len;
+
+            x = end;
+
+            /* outside of cropped region ? */
+            if (end <= crop_x || start >= x1) {
+                continue;
+            }
+
+            start = BD_MAX(start, crop_x);
+            end   = BD_MIN(end, x1);
+            _fill(dst + (start - crop_x), lut[img->color & 0xff], end - start);
+        }
+
+        /* short line */
+        if (x < x1) {
+            x = BD_MAX(x, crop_x);
+            _fill(dst + (x - crop_x), 0, x1 - x);
+        }
+
+        /* skip eol marker */
+        img++;
+    }
+}
+
+/*
+ * public API
+ */
+
+static int _decode(const BD_OVERLAY *ov, uint32_t *dst, unsigned stride,
+                   unsigned crop_x, unsigned crop_y, unsigned crop_w, unsigned crop_h,
+                   const uint32_t *lut)
+{
+    /* avoid overflows in crop rectangle checks */
+    if (!ov->img || !dst || stride < crop_w ||
+        crop_x > ov->w || crop_w > ov->w - crop_x ||
+        crop_y > ov->h || crop_h > ov->h - crop_y) {
+        BD_DEBUG(DBG_GC | DBG_CRIT, "bd_rle_decode(): invalid arguments\n");
+        return -1;
+    }
+
+    rle_decode_lut(dst, stride, ov->img, crop_x, crop_y, crop_w, crop_h, lut);
+    return 0;
+}
+
+int bd_rle_decode_argb(const BD_OVERLAY *ov, uint32_t *dst, unsigned stride,
+                       unsigned crop_x, unsigned crop_y, unsigned crop_w, unsigned crop_h,
+                       unsigned flags)
+{
+    uint32_t lut[256];
+
+    if (!ov || !ov->palette) {
+        return -1;
+    }
+
+    rle_palette_to_argb(lut, ov->palette, flags);
+    return _decode(ov, dst, stride, crop_x, crop_y, crop_w, crop_h, lut);
+}
+
+int bd_rle_decode_yuva(const BD_OVERLAY *ov, uint32_t *dst, unsigned stride,
+                       unsigned crop_x, unsigned crop_y, unsigned crop_w, unsigned crop_h)
+{
+    uint32_t lut[256];
+
+    if (!ov || !ov->palette) {
+        return -1;
+    }
+
+    rle_palette_to_yuva(lut, ov->palette);
+    return _decode(ov, dst, stride, crop_x, crop_y, crop_w, crop_h, lut);
+}
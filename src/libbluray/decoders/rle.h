@@ -45,8 +45,25 @@ typedef struct {
 #include "util/refcnt.h"
 #include "util/macro.h"
 
+/* line_idx (optional): index of first element of each line (rle_line_index()) */
 BD_PRIVATE BD_PG_RLE_ELEM *rle_crop_object(const BD_PG_RLE_ELEM *orig, int width,
-                                           int crop_x, int crop_y, int crop_w, int crop_h);
+                                           int crop_x, int crop_y, int crop_w, int crop_h,
+                                           const uint32_t *line_idx);
+BD_PRIVATE uint32_t       *rle_line_index(const BD_PG_RLE_ELEM *img, int width, int height);
+
+/*
+ * decompression
+ */
+
+/* convert palette to 256-entry lookup table (BD_RLE_DECODE_* flags) */
+BD_PRIVATE void rle_palette_to_argb(uint32_t *lut, const BD_PG_PALETTE_ENTRY *pal, unsigned flags);
+BD_PRIVATE void rle_palette_to_yuva(uint32_t *lut, const BD_PG_PALETTE_ENTRY *pal);
+
+/* expand cropped region of RLE image to 32-bit pixels using lookup table.
+ * Missing pixels (short lines) are set to 0. Crop region is not checked. */
+BD_PRIVATE void rle_decode_lut(uint32_t *dst, unsigned dst_stride, const BD_PG_RLE_ELEM *img,
+                               unsigned crop_x, unsigned crop_y, unsigned crop_w, unsigned crop_h,
+                               const uint32_t *lut);
 
 static inline int rle_begin(RLE_ENC *p)
 {
@@ -237,6 +237,31 @@ int libaacs_open(BD_AACS *p, const char *device,
     return error_code ? error_code : 1;
 }
 
+BD_AACS *libaacs_open_copy(BD_AACS *p, const char *device,
+                           void *file_open_handle, AACS_FILE_OPEN2 file_open_fp,
+                           const char *keyfile_path)
+{
+    BD_AACS *p2;
+
+    if (!p || !p->aacs) {
+        return NULL;
+    }
+
+    p2 = _load(p->impl_id);
+    if (!p2) {
+        return NULL;
+    }
+
+    /* must use the same implementation as original handle */
+    if (libaacs_open(p2, device, file_open_handle, file_open_fp, keyfile_path) || p2->impl_id != p->impl_id) {
+        BD_DEBUG(DBG_BLURAY | DBG_CRIT, "Opening additional AACS handle failed\n");
+        libaacs_unload(&p2);
+        return NULL;
+    }
+
+    return p2;
+}
+
 /*
  *
  */
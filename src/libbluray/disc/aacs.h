@@ -36,6 +36,11 @@ BD_PRIVATE int  libaacs_open(BD_AACS *p, const char *device,
                              const char *keyfile_path);
 BD_PRIVATE void libaacs_unload(BD_AACS **p);
 
+/* open another independent handle for the same disc (using the same AACS implementation as p) */
+BD_PRIVATE BD_AACS *libaacs_open_copy(BD_AACS *p, const char *device,
+                                      void *file_open_handle, AACS_FILE_OPEN2 file_open_fp,
+                                      const char *keyfile_path);
+
 BD_PRIVATE void libaacs_select_title(BD_AACS *p, uint32_t title);
 BD_PRIVATE int  libaacs_decrypt_unit(BD_AACS *p, uint8_t *buf);
 BD_PRIVATE int  libaacs_decrypt_bus(BD_AACS *p, uint8_t *buf);
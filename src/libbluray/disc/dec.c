@@ -26,18 +26,41 @@
 #include "enc_info.h"
 #include "aacs.h"
 #include "bdplus.h"
+#include "unit_cache.h"
 
 #include "file/file.h"
 #include "util/logging.h"
 #include "util/macro.h"
+#include "util/mutex.h"
 #include "util/strutl.h"
+#include "util/thread.h"
 
+#include <stdio.h>  // SEEK_*
 #include <string.h>
 
+#define DEC_MAX_THREADS 16
+
 struct bd_dec {
     int        use_menus;
     BD_AACS   *aacs;
     BD_BDPLUS *bdplus;
+
+    /* libaacs does not promise thread safety: each decryption worker uses its own AACS handle.
+     * aacs_mutex protects all handles (title selection vs. decryption). */
+    BD_MUTEX   aacs_mutex;
+    BD_AACS   *worker_aacs[DEC_MAX_THREADS - 1];
+    unsigned   num_worker_aacs;
+    uint32_t   aacs_title;
+    uint8_t    aacs_title_set;
+
+    /* for opening worker AACS handles */
+    char        *device;
+    char        *keyfile_path;
+    void        *file_open_vfs_handle;
+    file_openFp  pf_file_open_vfs;
+
+    BD_THREAD_POOL *pool;  /* AACS decryption workers */
+    BD_UNIT_CACHE  *cache; /* shared cache of decrypted units */
 };
 
 /*
@@ -45,34 +68,162 @@ struct bd_dec {
  */
 
 typedef struct {
-    BD_FILE_H    *fp;
-    BD_AACS      *aacs;
-    BD_BDPLUS_ST *bdplus;
+    BD_FILE_H      *fp;
+    BD_DEC         *dec;     /* NULL if not AACS encrypted */
+    BD_BDPLUS_ST   *bdplus;
+
+    /* shared cache of decrypted units */
+    BD_UNIT_CACHE  *cache;
+    uint64_t        file_id;
+    uint8_t         disc_id[20];
 } DEC_STREAM;
 
+/* split multi-unit reads to worker threads */
+
+typedef struct {
+    BD_AACS  *aacs[DEC_MAX_THREADS];    /* AACS handle for each job */
+    unsigned  failed[DEC_MAX_THREADS];  /* failed units in each job */
+    uint8_t  *buf;
+    unsigned  num_units;
+    unsigned  num_jobs;
+} DECRYPT_JOB;
+
+/* returns number of units that could not be decrypted */
+static unsigned _decrypt_units(BD_AACS *aacs, uint8_t *buf, unsigned num_units)
+{
+    unsigned ii, failed = 0;
+    for (ii = 0; ii < num_units; ii++) {
+        if (libaacs_decrypt_unit(aacs, buf + (size_t)ii * 6144)) {
+            /* failure is detected from TP header */
+            failed++;
+        }
+    }
+    return failed;
+}
+
+static void _decrypt_job(void *arg, unsigned idx)
+{
+    DECRYPT_JOB *job   = (DECRYPT_JOB *)arg;
+    unsigned     first = (unsigned)((uint64_t)job->num_units * idx / job->num_jobs);
+    unsigned     last  = (unsigned)((uint64_t)job->num_units * (idx + 1) / job->num_jobs);
+
+    job->failed[idx] = _decrypt_units(job->aacs[idx], job->buf + (size_t)first * 6144, last - first);
+}
+
+/* returns number of units that could not be decrypted */
+static unsigned _stream_decrypt(DEC_STREAM *st, uint8_t *buf, unsigned num_units)
+{
+    BD_DEC  *dec = st->dec;
+    unsigned num_jobs, failed = 0;
+
+    bd_mutex_lock(&dec->aacs_mutex);
+
+    num_jobs = BD_MIN(num_units, bd_thread_pool_num_threads(dec->pool) + 1);
+    num_jobs = BD_MIN(num_jobs, dec->num_worker_aacs + 1);
+
+    if (num_jobs > 1) {
+        DECRYPT_JOB job;
+        unsigned    ii;
+
+        job.aacs[0] = dec->aacs;
+        for (ii = 1; ii < num_jobs; ii++) {
+            job.aacs[ii] = dec->worker_aacs[ii - 1];
+        }
+        job.buf       = buf;
+        job.num_units = num_units;
+        job.num_jobs  = num_jobs;
+        bd_thread_pool_run(dec->pool, _decrypt_job, &job, num_jobs);
+
+        for (ii = 0; ii < num_jobs; ii++) {
+            failed += job.failed[ii];
+        }
+    } else {
+        failed = _decrypt_units(dec->aacs, buf, num_units);
+    }
+
+    bd_mutex_unlock(&dec->aacs_mutex);
+
+    return failed;
+}
+
+/* copy leading units from shared cache. Returns number of bytes copied. */
+static int64_t _stream_read_cached(DEC_STREAM *st, int64_t pos, uint8_t *buf, int64_t size)
+{
+    int64_t  got  = 0;
+    uint32_t unit = (uint32_t)(pos / 6144);
+
+    while (got < size && unit_cache_lookup(st->cache, st->disc_id, st->file_id, unit, buf + got)) {
+        got += 6144;
+        unit++;
+    }
+
+    /* skip cached data in input stream */
+    if (got > 0 && st->fp->seek(st->fp, pos + got, SEEK_SET) != pos + got) {
+        if (st->fp->seek(st->fp, pos, SEEK_SET) != pos) {
+            return -1;
+        }
+        got = 0;
+    }
+
+    return got;
+}
+
 static int64_t _stream_read(BD_FILE_H *fp, uint8_t *buf, int64_t size)
 {
     DEC_STREAM *st = (DEC_STREAM *)fp->internal;
-    int64_t     result;
+    int64_t     result = 0, got;
+    int64_t     pos = -1;
 
-    if (size != 6144) {
+    if (size <= 0 || size % 6144) {
         BD_DEBUG(DBG_CRIT, "read size != unit size\n");
         return 0;
     }
 
-    result = st->fp->read(st->fp, buf, size);
-    if (result <= 0) {
-        return result;
+    if (st->cache) {
+        pos = st->fp->tell(st->fp);
+        if (pos >= 0 && !(pos % 6144)) {
+            result = _stream_read_cached(st, pos, buf, size);
+            if (result < 0) {
+                return result;
+            }
+        } else {
+            pos = -1;
+        }
     }
 
-    if (st->aacs) {
-        if (libaacs_decrypt_unit(st->aacs, buf)) {
-            /* failure is detected from TP header */
+    if (result < size) {
+        got = st->fp->read(st->fp, buf + result, size - result);
+        if (got <= 0) {
+            if (result == 0) {
+                return got;
+            }
+        } else {
+
+            /* multiple units can be read at once. Decrypt only complete units.
+             * Units are independent, so they can be split to worker threads
+             * (each worker thread has its own AACS handle).
+             * BD+ fixups must be applied in stream order after decryption. */
+
+            if (st->dec) {
+                if (_stream_decrypt(st, buf + result, (unsigned)(got / 6144))) {
+                    /* do not cache encrypted data */
+                    pos = -1;
+                }
+            }
+
+            if (pos >= 0) {
+                int64_t off;
+                for (off = result; off + 6144 <= result + got; off += 6144) {
+                    unit_cache_insert(st->cache, st->disc_id, st->file_id, (uint32_t)((pos + off) / 6144), buf + off);
+                }
+            }
+
+            result += got;
         }
     }
 
     if (st->bdplus) {
-        if (libbdplus_fixup(st->bdplus, buf, (int)size) < 0) {
+        if (libbdplus_fixup(st->bdplus, buf, (int)result) < 0) {
           /* there's no way to verify if the stream was decoded correctly */
         }
     }
@@ -107,7 +258,35 @@ static void _stream_close(BD_FILE_H *fp)
     X_FREE(fp);
 }
 
-BD_FILE_H *dec_open_stream(BD_DEC *dec, BD_FILE_H *fp, uint32_t clip_id)
+/* select title in all AACS handles */
+static void _select_title(BD_DEC *dec, uint32_t title)
+{
+    unsigned ii;
+
+    bd_mutex_lock(&dec->aacs_mutex);
+
+    libaacs_select_title(dec->aacs, title);
+    for (ii = 0; ii < dec->num_worker_aacs; ii++) {
+        libaacs_select_title(dec->worker_aacs[ii], title);
+    }
+    dec->aacs_title     = title;
+    dec->aacs_title_set = 1;
+
+    bd_mutex_unlock(&dec->aacs_mutex);
+}
+
+/* FNV-1a */
+static uint64_t _path_hash(const char *path)
+{
+    uint64_t h = UINT64_C(0xcbf29ce484222325);
+    for (; *path; path++) {
+        h ^= (uint8_t)*path;
+        h *= UINT64_C(0x100000001b3);
+    }
+    return h;
+}
+
+BD_FILE_H *dec_open_stream(BD_DEC *dec, BD_FILE_H *fp, uint32_t clip_id, const char *path)
 {
     DEC_STREAM *st;
     BD_FILE_H  *p = calloc(1, sizeof(BD_FILE_H));
@@ -127,10 +306,18 @@ BD_FILE_H *dec_open_stream(BD_DEC *dec, BD_FILE_H *fp, uint32_t clip_id)
     }
 
     if (dec->aacs) {
-        st->aacs = dec->aacs;
+        st->dec = dec;
+        if (dec->cache) {
+            const uint8_t *disc_id = dec_disc_id(dec);
+            if (disc_id && path) {
+                st->cache   = dec->cache;
+                st->file_id = _path_hash(path);
+                memcpy(st->disc_id, disc_id, sizeof(st->disc_id));
+            }
+        }
         if (!dec->use_menus) {
             /* There won't be title events --> need to manually reset AACS CPS */
-            libaacs_select_title(dec->aacs, 0xffff);
+            _select_title(dec, 0xffff);
         }
     }
 
@@ -301,6 +488,10 @@ BD_DEC *dec_init(struct dec_dev *dev, BD_ENC_INFO *enc_info,
     if (!dec) {
         return NULL;
     }
+    if (bd_mutex_init(&dec->aacs_mutex) < 0) {
+        X_FREE(dec);
+        return NULL;
+    }
 
     /* load compatible libraries */
     _dec_load(dec, enc_info);
@@ -314,8 +505,18 @@ BD_DEC *dec_init(struct dec_dev *dev, BD_ENC_INFO *enc_info,
     if (!enc_info->aacs_handled) {
         /* AACS failed, clean up */
         dec_close(&dec);
+        return NULL;
     }
 
+    /* workers are started only if requested */
+    dec->pool = bd_thread_pool_init();
+
+    /* worker threads need own AACS handles */
+    dec->device               = str_dup(dev->device);
+    dec->keyfile_path         = str_dup(keyfile_path);
+    dec->file_open_vfs_handle = dev->file_open_vfs_handle;
+    dec->pf_file_open_vfs     = dev->pf_file_open_vfs;
+
     /* BD+ failure may be non-fatal (not all titles in disc use BD+).
      * Keep working AACS decoder even if BD+ init failed
      */
@@ -327,8 +528,16 @@ void dec_close(BD_DEC **pp)
 {
     if (pp && *pp) {
         BD_DEC *p = *pp;
+        bd_thread_pool_free(&p->pool);
+        while (p->num_worker_aacs > 0) {
+            libaacs_unload(&p->worker_aacs[--p->num_worker_aacs]);
+        }
         libaacs_unload(&p->aacs);
         libbdplus_unload(&p->bdplus);
+        X_FREE(p->device);
+        X_FREE(p->keyfile_path);
+        unit_cache_release(&p->cache);
+        bd_mutex_destroy(&p->aacs_mutex);
         X_FREE(*pp);
     }
 }
@@ -347,7 +556,9 @@ const uint8_t *dec_data(BD_DEC *dec, int type)
         }
     } else {
         if (dec->aacs) {
+            bd_mutex_lock(&dec->aacs_mutex);
             ret = libaacs_get_aacs_data(dec->aacs, type);
+            bd_mutex_unlock(&dec->aacs_mutex);
         }
     }
 
@@ -378,7 +589,7 @@ void dec_start(BD_DEC *dec, uint32_t num_titles)
 void dec_title(BD_DEC *dec, uint32_t title)
 {
     if (dec->aacs) {
-        libaacs_select_title(dec->aacs, title);
+        _select_title(dec, title);
     }
     if (dec->bdplus) {
         libbdplus_event(dec->bdplus, 0x110, title, 0);
@@ -391,3 +602,52 @@ void dec_application(BD_DEC *dec, uint32_t data)
         libbdplus_event(dec->bdplus, 0x210, data, 0);
     }
 }
+
+/*
+ * settings
+ */
+
+unsigned dec_set_threads(BD_DEC *dec, unsigned num_threads)
+{
+    unsigned num_workers;
+
+    if (!dec->pool || !dec->aacs) {
+        return 1;
+    }
+
+    /* calling thread decrypts too */
+    num_workers = BD_MIN(num_threads, DEC_MAX_THREADS);
+    num_workers = num_workers > 1 ? num_workers - 1 : 0;
+
+    /* each worker needs own AACS handle */
+    bd_mutex_lock(&dec->aacs_mutex);
+    while (dec->num_worker_aacs > num_workers) {
+        libaacs_unload(&dec->worker_aacs[--dec->num_worker_aacs]);
+    }
+    while (dec->num_worker_aacs < num_workers) {
+        BD_AACS *aacs = libaacs_open_copy(dec->aacs, dec->device,
+                                          dec->file_open_vfs_handle, dec->pf_file_open_vfs,
+                                          dec->keyfile_path);
+        if (!aacs) {
+            break;
+        }
+        if (dec->aacs_title_set) {
+            libaacs_select_title(aacs, dec->aacs_title);
+        }
+        dec->worker_aacs[dec->num_worker_aacs++] = aacs;
+    }
+    num_workers = dec->num_worker_aacs;
+    bd_mutex_unlock(&dec->aacs_mutex);
+
+    return bd_thread_pool_set_threads(dec->pool, num_workers) + 1;
+}
+
+void dec_set_unit_cache(BD_DEC *dec, unsigned max_units)
+{
+    unit_cache_release(&dec->cache);
+
+    /* caching is useful only when decrypting */
+    if (dec->aacs && dec_disc_id(dec)) {
+        dec->cache = unit_cache_get(max_units);
+    }
+}
@@ -60,8 +60,14 @@ BD_PRIVATE void dec_start(BD_DEC *, uint32_t num_titles);
 BD_PRIVATE void dec_title(BD_DEC *, uint32_t title);
 BD_PRIVATE void dec_application(BD_DEC *, uint32_t data);
 
-/* open low-level stream */
-BD_PRIVATE struct bd_file_s *dec_open_stream(BD_DEC *dec, struct bd_file_s *fp, uint32_t clip_id);
+/* set number of threads used for stream decryption. Returns actual number of threads. */
+BD_PRIVATE unsigned dec_set_threads(BD_DEC *, unsigned num_threads);
+
+/* use shared cache of decrypted units (0 = disabled). Must be set before opening streams. */
+BD_PRIVATE void dec_set_unit_cache(BD_DEC *, unsigned max_units);
+
+/* open low-level stream. path (relative to disc root) identifies file in unit cache. */
+BD_PRIVATE struct bd_file_s *dec_open_stream(BD_DEC *dec, struct bd_file_s *fp, uint32_t clip_id, const char *path);
 
 
 #endif /* _BD_DISC_DEC_H_ */
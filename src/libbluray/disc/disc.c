@@ -25,6 +25,7 @@
 
 #include "dec.h"
 #include "properties.h"
+#include "readahead.h"
 
 #include "util/refcnt.h"
 #include "util/logging.h"
@@ -41,6 +42,28 @@
 
 #include "udf_fs.h"
 
+/*
+ * disc cache: hash table, split to shards with separate locks
+ */
+
+#define DISC_CACHE_SHARDS   8
+#define DISC_CACHE_NAME_LEN 11
+
+typedef struct disc_cache_entry_s DISC_CACHE_ENTRY;
+struct disc_cache_entry_s {
+    DISC_CACHE_ENTRY *next;
+    uint32_t          hash;
+    char              name[DISC_CACHE_NAME_LEN];
+    const void       *data;
+};
+
+typedef struct {
+    BD_MUTEX           mutex;
+    DISC_CACHE_ENTRY **bucket;
+    unsigned           num_buckets;  /* power of 2, 0 if not allocated */
+    unsigned           count;
+} DISC_CACHE_SHARD;
+
 struct bd_disc {
     BD_MUTEX  ovl_mutex;     /* protect access to overlay root */
     BD_MUTEX  properties_mutex; /* protect access to properties file */
@@ -59,14 +82,11 @@ struct bd_disc {
     char         *properties_file;  /* NULL if not yet used */
 
     int8_t        avchd;  /* -1 - unknown. 0 - no. 1 - yes */
+    uint8_t       use_mmap;
+    unsigned      async_io_units;
 
     /* disc cache */
-    BD_MUTEX        cache_mutex;
-    size_t          cache_size;
-    struct {
-        char        name[11];
-        const void *data;
-    } *cache;
+    DISC_CACHE_SHARD cache[DISC_CACHE_SHARDS];
 };
 
 /*
@@ -84,7 +104,20 @@ static BD_FILE_H *_bdrom_open_path(void *p, const char *rel_path)
         return NULL;
     }
 
-    fp = file_open(abs_path, "rb");
+    fp = NULL;
+    if (!strncmp(rel_path, "BDMV" DIR_SEP "STREAM" DIR_SEP, sizeof("BDMV" DIR_SEP "STREAM" DIR_SEP) - 1)) {
+        if (disc->use_mmap) {
+            fp = file_open_mmap(abs_path);
+        }
+#ifdef HAVE_LIBURING
+        if (!fp && disc->async_io_units) {
+            fp = file_open_uring(abs_path, disc->async_io_units);
+        }
+#endif
+    }
+    if (!fp) {
+        fp = file_open(abs_path, "rb");
+    }
     X_FREE(abs_path);
 
     return fp;
@@ -276,9 +309,13 @@ static BD_DISC *_disc_init()
 {
     BD_DISC *p = calloc(1, sizeof(BD_DISC));
     if (p) {
+        unsigned ii;
+
         bd_mutex_init(&p->ovl_mutex);
         bd_mutex_init(&p->properties_mutex);
-        bd_mutex_init(&p->cache_mutex);
+        for (ii = 0; ii < DISC_CACHE_SHARDS; ii++) {
+            bd_mutex_init(&p->cache[ii].mutex);
+        }
 
         /* default file access functions */
         p->fs_handle          = (void*)p;
@@ -306,7 +343,7 @@ static void _set_paths(BD_DISC *p, const char *device_path)
 }
 
 BD_DISC *disc_open(const char *device_path,
-                   fs_access *p_fs,
+                   fs_access *p_fs, int use_mmap,
                    struct bd_enc_info *enc_info,
                    const char *keyfile_path,
                    void *regs, void *psr_read, void *psr_write)
@@ -323,12 +360,14 @@ BD_DISC *disc_open(const char *device_path,
         p->pf_dir_open_bdrom  = p_fs->open_dir;
     }
 
+    p->use_mmap = !!use_mmap;
+
     _set_paths(p, device_path);
 
     /* check if disc root directory can be opened. If not, treat it as device/image file. */
     BD_DIR_H *dp_img = device_path ? dir_open(device_path) : NULL;
     if (!dp_img) {
-        void *udf = udf_image_open(device_path, p_fs ? p_fs->fs_handle : NULL, p_fs ? p_fs->read_blocks : NULL);
+        void *udf = udf_image_open(device_path, use_mmap, p_fs ? p_fs->fs_handle : NULL, p_fs ? p_fs->read_blocks : NULL);
         if (!udf) {
             BD_DEBUG(DBG_FILE | DBG_CRIT, "failed opening UDF image %s\n", device_path);
         } else {
@@ -357,6 +396,7 @@ void disc_close(BD_DISC **pp)
 {
     if (pp && *pp) {
         BD_DISC *p = *pp;
+        unsigned ii;
 
         dec_close(&p->dec);
 
@@ -368,7 +408,9 @@ void disc_close(BD_DISC **pp)
 
         bd_mutex_destroy(&p->ovl_mutex);
         bd_mutex_destroy(&p->properties_mutex);
-        bd_mutex_destroy(&p->cache_mutex);
+        for (ii = 0; ii < DISC_CACHE_SHARDS; ii++) {
+            bd_mutex_destroy(&p->cache[ii].mutex);
+        }
 
         X_FREE(p->disc_root);
         X_FREE(p->properties_file);
@@ -483,7 +525,7 @@ size_t disc_read_file(BD_DISC *disc, const char *dir, const char *file,
                        uint8_t **data)
 {
     BD_FILE_H *fp;
-    int64_t    size;
+    size_t     size;
 
     *data = NULL;
 
@@ -496,26 +538,13 @@ size_t disc_read_file(BD_DISC *disc, const char *dir, const char *file,
         return 0;
     }
 
-    size = file_size(fp);
-    if (size > 0 && size < BD_MAX_SSIZE) {
-        *data = malloc((size_t)size);
-        if (*data) {
-            int64_t got = file_read(fp, *data, size);
-            if (got != size) {
-                BD_DEBUG(DBG_FILE | DBG_CRIT, "Error reading file %s from %s\n", file, dir);
-                X_FREE(*data);
-                size = 0;
-            }
-        } else {
-          size = 0;
-        }
-    }
-    else {
-      size = 0;
+    size = file_read_all(fp, data);
+    if (!size && file_size(fp) > 0) {
+        BD_DEBUG(DBG_FILE | DBG_CRIT, "Error reading file %s from %s\n", file, dir ? dir : "");
     }
 
     file_close(fp);
-    return (size_t)size;
+    return size;
 }
 
 /*
@@ -532,6 +561,9 @@ void disc_update(BD_DISC *p, const char *overlay_root)
     }
 
     bd_mutex_unlock(&p->ovl_mutex);
+
+    /* parsed playlists / clip info may come from old virtual package */
+    disc_cache_clean(p, NULL);
 }
 
 int disc_cache_bdrom_file(BD_DISC *p, const char *rel_path, const char *cache_path)
@@ -593,16 +625,16 @@ int disc_cache_bdrom_file(BD_DISC *p, const char *rel_path, const char *cache_pa
 }
 
 /*
- * persistent properties storage
+ * persistent per-disc data
  */
 
-static char *_properties_file(BD_DISC *p)
+char *disc_persistent_path(BD_DISC *p, const char *type)
 {
     const uint8_t *disc_id = NULL;
     uint8_t  pseudo_id[20];
     char     id_type, id_str[41];
     char    *cache_home;
-    char    *properties_file;
+    char    *path;
 
     /* get disc ID */
     if (p->dec) {
@@ -624,20 +656,24 @@ static char *_properties_file(BD_DISC *p)
         return NULL;
     }
 
-    properties_file = str_printf("%s" DIR_SEP "bluray" DIR_SEP "properties" DIR_SEP "%c%s",
-                                 cache_home, id_type,
-                                 str_print_hex(id_str, disc_id, 20));
+    path = str_printf("%s" DIR_SEP "bluray" DIR_SEP "%s" DIR_SEP "%c%s",
+                      cache_home, type, id_type,
+                      str_print_hex(id_str, disc_id, 20));
 
     X_FREE(cache_home);
 
-    return properties_file;
+    return path;
 }
 
+/*
+ * persistent properties storage
+ */
+
 static int _ensure_properties_file(BD_DISC *p)
 {
     bd_mutex_lock(&p->properties_mutex);
     if (!p->properties_file) {
-        p->properties_file = _properties_file(p);
+        p->properties_file = disc_persistent_path(p, "properties");
     }
     bd_mutex_unlock(&p->properties_mutex);
 
@@ -678,10 +714,11 @@ char *disc_property_get(BD_DISC *p, const char *property)
  * streams
  */
 
-static BD_FILE_H *_open_stream(BD_DISC *disc, BD_FILE_H *fp, const char *file)
+/* path: relative to disc root, file: file name in path */
+static BD_FILE_H *_open_stream(BD_DISC *disc, BD_FILE_H *fp, const char *path, const char *file)
 {
     if (disc->dec) {
-        BD_FILE_H *st = dec_open_stream(disc->dec, fp, atoi(file));
+        BD_FILE_H *st = dec_open_stream(disc->dec, fp, atoi(file), path);
         if (st) {
             return st;
         }
@@ -690,11 +727,57 @@ static BD_FILE_H *_open_stream(BD_DISC *disc, BD_FILE_H *fp, const char *file)
     return fp;
 }
 
+static BD_FILE_H *_open_stream_file(BD_DISC *disc, BD_FILE_H *fp, const char *file)
+{
+    char *path = str_printf("BDMV" DIR_SEP "STREAM" DIR_SEP "%s", file);
+
+    /* without path units are not cached */
+    fp = _open_stream(disc, fp, path, file);
+    X_FREE(path);
+    return fp;
+}
+
 BD_FILE_H *disc_open_stream(BD_DISC *disc, const char *file)
 {
     BD_FILE_H *fp = disc_open_file(disc, "BDMV" DIR_SEP "STREAM", file);
 
-    return fp ? _open_stream(disc, fp, file) : fp;
+    return fp ? _open_stream_file(disc, fp, file) : fp;
+}
+
+BD_FILE_H *disc_open_stream_readahead(BD_DISC *disc, const char *file,
+                                      BD_READAHEAD *ra, int64_t start_pos, int64_t end_pos)
+{
+    BD_FILE_H *fp = disc_open_file(disc, "BDMV" DIR_SEP "STREAM", file);
+    BD_FILE_H *ra_fp;
+
+    if (!fp) {
+        return NULL;
+    }
+
+    /* buffer raw data. Read-ahead worker must not call AACS / BD+ libraries. */
+    ra_fp = readahead_open(ra, fp, start_pos, end_pos);
+    if (ra_fp) {
+        fp = ra_fp;
+    }
+
+    return _open_stream_file(disc, fp, file);
+}
+
+void disc_prefetch_stream(BD_DISC *disc, const char *file, int64_t offset, int64_t size)
+{
+    char *path;
+
+    /* only local BDMV folders. AVCHD uses different file names. */
+    if (disc->pf_file_open_bdrom != _bdrom_open_path || disc->avchd > 0) {
+        return;
+    }
+
+    path = str_printf("%sBDMV" DIR_SEP "STREAM" DIR_SEP "%s", disc->disc_root, file);
+    if (path) {
+        BD_DEBUG(DBG_FILE, "prefetch %s\n", file);
+        file_prefetch(path, offset, size);
+        X_FREE(path);
+    }
 }
 
 BD_FILE_H *disc_open_path_dec(BD_DISC *p, const char *rel_path)
@@ -710,11 +793,11 @@ BD_FILE_H *disc_open_path_dec(BD_DISC *p, const char *rel_path)
     if (!strncmp(rel_path, "BDMV" DIR_SEP "STREAM", 11)) {
         const char *suf = rel_path + (strlen(rel_path) - 5);
         if (!strcmp(suf, ".m2ts")) { // equal
-            fp = _open_stream(p, fp, suf - 5);
+            fp = _open_stream(p, fp, rel_path, suf - 5);
         } else if (!strcmp(suf+1, ".MTS")) { // equal
-            fp = _open_stream(p, fp, suf - 4);
+            fp = _open_stream(p, fp, rel_path, suf - 4);
         } else if (!strcmp(suf, ".ssif")) { // equal
-            fp = _open_stream(p, fp, suf - 5);
+            fp = _open_stream(p, fp, rel_path, suf - 5);
         } else {
             BD_DEBUG(DBG_FILE | DBG_CRIT, "unsupported stream file extension in %s\n", rel_path);
         }
@@ -761,6 +844,34 @@ void disc_event(BD_DISC *disc, uint32_t event, uint32_t param)
     }
 }
 
+void disc_set_decrypt_threads(BD_DISC *disc, unsigned num_threads)
+{
+    if (disc && disc->dec) {
+        dec_set_threads(disc->dec, num_threads);
+    }
+}
+
+void disc_set_unit_cache(BD_DISC *disc, unsigned max_units)
+{
+    if (disc && disc->dec) {
+        dec_set_unit_cache(disc->dec, max_units);
+    }
+}
+
+void disc_set_async_io(BD_DISC *disc, unsigned num_units)
+{
+    if (disc) {
+#ifdef HAVE_LIBURING
+        /* applied when next stream file is opened */
+        disc->async_io_units = num_units;
+#else
+        if (num_units) {
+            BD_DEBUG(DBG_FILE | DBG_CRIT, "Asynchronous I/O not supported\n");
+        }
+#endif
+    }
+}
+
 /*
  * Pseudo disc ID
  * This is used when AACS disc ID is not available
@@ -853,28 +964,109 @@ int disc_pseudo_id(BD_DISC *p, uint8_t *id/*[20]*/)
  *
  */
 
-const void *disc_cache_get(BD_DISC *p, const char *name)
+static uint32_t _cache_hash(const char *name)
 {
-    const void *data = NULL;
+    uint32_t h = 2166136261u;  /* FNV-1a */
 
-    bd_mutex_lock(&p->cache_mutex);
-    if (p->cache) {
-        size_t i;
-        for (i = 0; p->cache[i].data; i++) {
-            if (!strcmp(p->cache[i].name, name)) {
-                data = refcnt_inc(p->cache[i].data);
-                break;
-            }
+    for (; *name; name++) {
+        h ^= (uint8_t)*name;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static DISC_CACHE_SHARD *_cache_shard(BD_DISC *p, uint32_t hash)
+{
+    return &p->cache[hash % DISC_CACHE_SHARDS];
+}
+
+/* find entry. Returns pointer to link pointing to entry, or NULL. */
+static DISC_CACHE_ENTRY **_cache_find(DISC_CACHE_SHARD *s, uint32_t hash, const char *name)
+{
+    DISC_CACHE_ENTRY **pe;
+
+    if (!s->num_buckets) {
+        return NULL;
+    }
+
+    for (pe = &s->bucket[(hash / DISC_CACHE_SHARDS) & (s->num_buckets - 1)]; *pe; pe = &(*pe)->next) {
+        if ((*pe)->hash == hash && !strcmp((*pe)->name, name)) {
+            return pe;
+        }
+    }
+    return NULL;
+}
+
+static void _cache_grow(DISC_CACHE_SHARD *s)
+{
+    DISC_CACHE_ENTRY **bucket;
+    unsigned num_buckets = s->num_buckets ? 2 * s->num_buckets : 16;
+    unsigned ii;
+
+    bucket = calloc(num_buckets, sizeof(*bucket));
+    if (!bucket) {
+        /* keep using old table */
+        return;
+    }
+
+    for (ii = 0; ii < s->num_buckets; ii++) {
+        DISC_CACHE_ENTRY *e = s->bucket[ii];
+        while (e) {
+            DISC_CACHE_ENTRY *next = e->next;
+            unsigned b = (e->hash / DISC_CACHE_SHARDS) & (num_buckets - 1);
+            e->next = bucket[b];
+            bucket[b] = e;
+            e = next;
         }
     }
-    bd_mutex_unlock(&p->cache_mutex);
+
+    X_FREE(s->bucket);
+    s->bucket      = bucket;
+    s->num_buckets = num_buckets;
+}
+
+static void _cache_clean_shard(DISC_CACHE_SHARD *s)
+{
+    unsigned ii;
+
+    for (ii = 0; ii < s->num_buckets; ii++) {
+        DISC_CACHE_ENTRY *e = s->bucket[ii];
+        while (e) {
+            DISC_CACHE_ENTRY *next = e->next;
+            refcnt_dec(e->data);
+            X_FREE(e);
+            e = next;
+        }
+    }
+    X_FREE(s->bucket);
+    s->num_buckets = 0;
+    s->count = 0;
+}
+
+const void *disc_cache_get(BD_DISC *p, const char *name)
+{
+    const void *data = NULL;
+    uint32_t hash = _cache_hash(name);
+    DISC_CACHE_SHARD *s = _cache_shard(p, hash);
+    DISC_CACHE_ENTRY **pe;
+
+    bd_mutex_lock(&s->mutex);
+    pe = _cache_find(s, hash, name);
+    if (pe) {
+        data = refcnt_inc((*pe)->data);
+    }
+    bd_mutex_unlock(&s->mutex);
 
     return data;
 }
 
 void disc_cache_put(BD_DISC *p, const char *name, const void *data)
 {
-    if (strlen(name) >= sizeof(p->cache[0].name)) {
+    uint32_t hash;
+    DISC_CACHE_SHARD *s;
+    DISC_CACHE_ENTRY **pe, *e;
+
+    if (strlen(name) >= DISC_CACHE_NAME_LEN) {
         BD_DEBUG(DBG_FILE|DBG_CRIT, "disc_cache_put: key %s too large\n", name);
         return;
     }
@@ -883,70 +1075,72 @@ void disc_cache_put(BD_DISC *p, const char *name, const void *data)
         return;
     }
 
-    bd_mutex_lock(&p->cache_mutex);
+    hash = _cache_hash(name);
+    s    = _cache_shard(p, hash);
 
-    if (!p->cache) {
-        p->cache_size = 128;
-        p->cache = calloc(p->cache_size, sizeof(*p->cache));
+    bd_mutex_lock(&s->mutex);
+
+    pe = _cache_find(s, hash, name);
+    if (pe) {
+        BD_DEBUG(DBG_FILE|DBG_CRIT, "disc_cache_put(): duplicate key %s\n", name);
+        e = *pe;
+        refcnt_dec(e->data);
+        *pe = e->next;
+        X_FREE(e);
+        s->count--;
     }
 
-    if (p->cache && p->cache[p->cache_size - 2].data) {
-        void *tmp = realloc(p->cache, 2 * p->cache_size * sizeof(p->cache[0]));
-        if (tmp) {
-            p->cache = tmp;
-            memset(&p->cache[p->cache_size], 0, p->cache_size * sizeof(p->cache[0]));
-            p->cache_size *= 2;
-        }
+    if (s->count >= s->num_buckets) {
+        _cache_grow(s);
     }
 
-    if (p->cache && !p->cache[p->cache_size - 2].data) {
-        size_t i;
-        for (i = 0; p->cache[i].data; i++) {
-            if (!strcmp(p->cache[i].name, name)) {
-                BD_DEBUG(DBG_FILE|DBG_CRIT, "disc_cache_put(): duplicate key %s\n", name);
-                refcnt_dec(p->cache[i].data);
-                break;
-            }
-        }
-        strcpy(p->cache[i].name, name);
-        p->cache[i].data = refcnt_inc(data);
-        if (p->cache[i].data) {
+    e = s->num_buckets ? calloc(1, sizeof(*e)) : NULL;
+    if (e) {
+        unsigned b = (hash / DISC_CACHE_SHARDS) & (s->num_buckets - 1);
+
+        e->data = refcnt_inc(data);
+        if (e->data) {
+            e->hash = hash;
+            strcpy(e->name, name);
+            e->next = s->bucket[b];
+            s->bucket[b] = e;
+            s->count++;
             BD_DEBUG(DBG_FILE, "disc_cache_put: added %s (%p)\n", name, data);
         } else {
             BD_DEBUG(DBG_FILE|DBG_CRIT, "disc_cache_put: error adding %s (%p): Invalid object type\n", name, data);
+            X_FREE(e);
         }
     } else {
         BD_DEBUG(DBG_FILE|DBG_CRIT, "disc_cache_put: error adding %s (%p): Out of memory\n", name, data);
     }
 
-    bd_mutex_unlock(&p->cache_mutex);
+    bd_mutex_unlock(&s->mutex);
 }
 
 void disc_cache_clean(BD_DISC *p, const char *name)
 {
-    bd_mutex_lock(&p->cache_mutex);
-
-    if (p->cache) {
-        size_t i;
-        if (name == NULL) {
-            for (i = 0; p->cache[i].data; i++) {
-                refcnt_dec(p->cache[i].data);
-            }
-            X_FREE(p->cache);
-            p->cache_size = 0;
-        } else {
-            for (i = 0; p->cache[i].data; i++) {
-                if (!strcmp(p->cache[i].name, name)) {
-                    BD_DEBUG(DBG_FILE, "disc_cache_clean: dropped %s (%p)\n", name, p->cache[i].data);
-                    refcnt_dec(p->cache[i].data);
-                    break;
-                }
-            }
-            for (; p->cache[i].data; i++) {
-                p->cache[i] = p->cache[i + 1];
-            }
+    if (name == NULL) {
+        unsigned ii;
+        for (ii = 0; ii < DISC_CACHE_SHARDS; ii++) {
+            bd_mutex_lock(&p->cache[ii].mutex);
+            _cache_clean_shard(&p->cache[ii]);
+            bd_mutex_unlock(&p->cache[ii].mutex);
         }
+    } else {
+        uint32_t hash = _cache_hash(name);
+        DISC_CACHE_SHARD *s = _cache_shard(p, hash);
+        DISC_CACHE_ENTRY **pe;
+
+        bd_mutex_lock(&s->mutex);
+        pe = _cache_find(s, hash, name);
+        if (pe) {
+            DISC_CACHE_ENTRY *e = *pe;
+            BD_DEBUG(DBG_FILE, "disc_cache_clean: dropped %s (%p)\n", name, e->data);
+            refcnt_dec(e->data);
+            *pe = e->next;
+            X_FREE(e);
+            s->count--;
+        }
+        bd_mutex_unlock(&s->mutex);
     }
-
-    bd_mutex_unlock(&p->cache_mutex);
 }
@@ -28,6 +28,7 @@
 struct bd_file_s;
 struct bd_dir_s;
 struct bd_enc_info;
+struct bd_readahead;
 
 /* application provided file system access (optional) */
 typedef struct fs_access {
@@ -49,8 +50,9 @@ typedef struct fs_access {
 
 typedef struct bd_disc BD_DISC;
 
+/* use_mmap: use memory-mapped I/O for local stream files and disc images */
 BD_PRIVATE BD_DISC *disc_open(const char *device_path,
-                              fs_access *p_fs,
+                              fs_access *p_fs, int use_mmap,
                               struct bd_enc_info *enc_info,
                               const char *keyfile_path,
                               void *regs, void *psr_read, void *psr_write);
@@ -95,6 +97,15 @@ BD_PRIVATE struct bd_dir_s  *disc_open_bdrom_dir(BD_DISC *disc, const char *path
 
 BD_PRIVATE struct bd_file_s *disc_open_stream(BD_DISC *disc, const char *file);
 
+/* Open stream with background read-ahead of raw (encrypted) data.
+ * Decryption is done in the reading thread. */
+BD_PRIVATE struct bd_file_s *disc_open_stream_readahead(BD_DISC *disc, const char *file,
+                                                        struct bd_readahead *ra,
+                                                        int64_t start_pos, int64_t end_pos);
+
+/* Hint OS to cache start of stream file (no-op if disc is not a local BDMV folder) */
+BD_PRIVATE void disc_prefetch_stream(BD_DISC *disc, const char *file, int64_t offset, int64_t size);
+
 /*
  * Store / fetch persistent properties for disc.
  * Data is stored in cache directory and persists between playback sessions.
@@ -110,6 +121,14 @@ BD_PRIVATE char *disc_property_get(BD_DISC *disc, const char *property);
 #define DISC_PROPERTY_PLAYLISTS    "Playlists"
 #define DISC_PROPERTY_MAIN_FEATURE "MainFeature"
 
+/*
+ * Path for persistent per-disc data of given type in cache directory.
+ * Path is unique for each disc (AACS disc ID or pseudo ID).
+ * Returns NULL if disc can't be identified.
+ */
+
+BD_PRIVATE char *disc_persistent_path(BD_DISC *disc, const char *type);
+
 /*
  *
  */
@@ -124,6 +143,15 @@ enum {
 
 BD_PRIVATE void disc_event(BD_DISC *, uint32_t event, uint32_t param);
 
+/* number of threads used for stream decryption (0 or 1 = decrypt in reading thread) */
+BD_PRIVATE void disc_set_decrypt_threads(BD_DISC *, unsigned num_threads);
+
+/* number of 6144-byte units read ahead asynchronously from local stream files (0 = disabled) */
+BD_PRIVATE void disc_set_async_io(BD_DISC *, unsigned num_units);
+
+/* size of process-wide cache of decrypted units (0 = disabled). Must be set before opening streams. */
+BD_PRIVATE void disc_set_unit_cache(BD_DISC *, unsigned max_units);
+
 /*
  * cache
  *
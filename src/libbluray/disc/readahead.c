@@ -0,0 +1,451 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "readahead.h"
+
+#include "file/file.h"
+#include "util/logging.h"
+#include "util/macro.h"
+#include "util/mutex.h"
+#include "util/thread.h"
+
+#include <inttypes.h>
+#include <stdio.h>   // SEEK_*
+#include <stdlib.h>
+#include <string.h>
+
+#define RA_UNIT       6144
+#define RA_MAX_READ   32    /* max. units in single read call */
+
+typedef struct ra_stream RA_STREAM;
+
+struct ra_stream {
+    BD_READAHEAD *ra;
+    RA_STREAM    *next;        /* next stream in worker queue */
+
+    BD_FILE_H    *fp;          /* wrapped stream. Used only by worker thread after opening. */
+    int64_t       fp_pos;      /* current position of wrapped stream (-1 = unknown) */
+    int64_t       size;
+
+    int64_t       pos;         /* application read position */
+
+    /* ring buffer */
+    uint8_t      *buf;
+    int64_t       buf_pos;     /* file position of first buffered unit */
+    unsigned      head;        /* first buffered unit */
+    unsigned      count;       /* number of buffered units */
+    int64_t       fill_limit;  /* do not buffer past this position */
+    unsigned      gen;         /* incremented when buffer is flushed */
+    uint8_t       eof;         /* end of file or read error. Cleared when buffer is flushed. */
+    uint8_t       waiting;     /* reader is waiting for data */
+};
+
+struct bd_readahead {
+    BD_MUTEX   mutex;
+    BD_COND    work_cond;      /* worker waits for space in buffers */
+    BD_COND    data_cond;      /* readers wait for data */
+    BD_THREAD  thread;
+
+    unsigned   num_units;
+    RA_STREAM *streams;        /* streams in opening order */
+    RA_STREAM *busy;           /* stream worker is reading without lock */
+    uint8_t    quit;
+};
+
+/*
+ * worker
+ */
+
+static RA_STREAM *_find_work(BD_READAHEAD *ra)
+{
+    RA_STREAM *s;
+
+    /* blocked reader first (earlier streams may have full buffers) */
+    for (s = ra->streams; s; s = s->next) {
+        if (s->waiting && !s->count && !s->eof && s->buf_pos < s->size) {
+            return s;
+        }
+    }
+
+    for (s = ra->streams; s; s = s->next) {
+        int64_t fill_pos = s->buf_pos + (int64_t)s->count * RA_UNIT;
+
+        if (s->eof || fill_pos >= s->size) {
+            continue;
+        }
+        if (fill_pos >= s->fill_limit) {
+            /* buffered up to end limit, continue with next stream */
+            continue;
+        }
+        if (s->count < ra->num_units) {
+            return s;
+        }
+        return NULL;
+    }
+
+    return NULL;
+}
+
+static void *_worker(void *arg)
+{
+    BD_READAHEAD *ra = (BD_READAHEAD *)arg;
+
+    bd_mutex_lock(&ra->mutex);
+
+    while (!ra->quit) {
+        RA_STREAM *s = _find_work(ra);
+        int64_t    fill_pos, limit;
+        unsigned   slot, num_units, gen;
+        size_t     got = 0;
+
+        if (!s) {
+            bd_cond_wait(&ra->work_cond, &ra->mutex);
+            continue;
+        }
+
+        fill_pos  = s->buf_pos + (int64_t)s->count * RA_UNIT;
+        limit     = BD_MIN(s->fill_limit, s->size);
+        slot      = (s->head + s->count) % ra->num_units;
+        num_units = BD_MIN(ra->num_units - s->count, ra->num_units - slot);
+        num_units = BD_MIN(num_units, RA_MAX_READ);
+        num_units = BD_MIN(num_units, (unsigned)((limit - fill_pos + RA_UNIT - 1) / RA_UNIT));
+        gen       = s->gen;
+        ra->busy  = s;
+
+        bd_mutex_unlock(&ra->mutex);
+
+        if (s->fp_pos != fill_pos) {
+            s->fp_pos = file_seek(s->fp, fill_pos, SEEK_SET);
+        }
+        if (s->fp_pos == fill_pos) {
+            got = file_read(s->fp, s->buf + (size_t)slot * RA_UNIT, (size_t)num_units * RA_UNIT);
+            s->fp_pos = (got == (size_t)num_units * RA_UNIT) ? fill_pos + (int64_t)got : -1;
+        }
+
+        bd_mutex_lock(&ra->mutex);
+
+        ra->busy = NULL;
+        if (gen == s->gen) {
+            unsigned units = (unsigned)(got / RA_UNIT);
+            s->count += units;
+            if (units < num_units) {
+                BD_DEBUG(DBG_FILE, "read-ahead stopped at %" PRId64 " (%p)\n", fill_pos + (int64_t)units * RA_UNIT, (void*)s);
+                s->eof = 1;
+            }
+        }
+
+        bd_cond_broadcast(&ra->data_cond);
+    }
+
+    bd_mutex_unlock(&ra->mutex);
+
+    return NULL;
+}
+
+/*
+ * stream
+ */
+
+static void _sync_pos(RA_STREAM *s)
+{
+    BD_READAHEAD *ra = s->ra;
+    int64_t       end = s->buf_pos + (int64_t)s->count * RA_UNIT;
+
+    if (s->pos == s->buf_pos) {
+        return;
+    }
+
+    if (s->pos > s->buf_pos && s->pos < end && !((s->pos - s->buf_pos) % RA_UNIT)) {
+        /* skip buffered units */
+        unsigned skip = (unsigned)((s->pos - s->buf_pos) / RA_UNIT);
+        s->head     = (s->head + skip) % ra->num_units;
+        s->count   -= skip;
+        s->buf_pos  = s->pos;
+    } else {
+        /* flush */
+        BD_DEBUG(DBG_FILE, "read-ahead flushed, new position %" PRId64 " (%p)\n", s->pos, (void*)s);
+        s->gen++;
+        s->head    = 0;
+        s->count   = 0;
+        s->buf_pos = s->pos;
+        s->eof     = 0;
+    }
+
+    if (s->pos >= s->fill_limit) {
+        s->fill_limit = s->size;
+    }
+
+    bd_cond_signal(&ra->work_cond);
+}
+
+static int64_t _stream_read(BD_FILE_H *fp, uint8_t *buf, int64_t size)
+{
+    RA_STREAM    *s  = (RA_STREAM *)fp->internal;
+    BD_READAHEAD *ra = s->ra;
+    int64_t       got = 0;
+
+    if (size <= 0 || size % RA_UNIT) {
+        BD_DEBUG(DBG_FILE | DBG_CRIT, "read-ahead: read size != unit size\n");
+        return 0;
+    }
+
+    bd_mutex_lock(&ra->mutex);
+
+    _sync_pos(s);
+
+    while (got < size) {
+        unsigned num_units;
+
+        if (s->count == 0) {
+            if (s->eof || s->buf_pos >= s->size) {
+                break;
+            }
+            if (s->buf_pos >= s->fill_limit) {
+                s->fill_limit = s->size;
+            }
+            s->waiting = 1;
+            bd_cond_signal(&ra->work_cond);
+            bd_cond_wait(&ra->data_cond, &ra->mutex);
+            s->waiting = 0;
+            continue;
+        }
+
+        num_units = (unsigned)((size - got) / RA_UNIT);
+        num_units = BD_MIN(num_units, s->count);
+        num_units = BD_MIN(num_units, ra->num_units - s->head);
+
+        memcpy(buf + got, s->buf + (size_t)s->head * RA_UNIT, (size_t)num_units * RA_UNIT);
+
+        s->head     = (s->head + num_units) % ra->num_units;
+        s->count   -= num_units;
+        s->buf_pos += (int64_t)num_units * RA_UNIT;
+        s->pos     += (int64_t)num_units * RA_UNIT;
+        got        += (int64_t)num_units * RA_UNIT;
+
+        bd_cond_signal(&ra->work_cond);
+    }
+
+    bd_mutex_unlock(&ra->mutex);
+
+    return got;
+}
+
+static int64_t _stream_seek(BD_FILE_H *fp, int64_t offset, int32_t origin)
+{
+    RA_STREAM    *s  = (RA_STREAM *)fp->internal;
+    BD_READAHEAD *ra = s->ra;
+    int64_t       pos;
+
+    bd_mutex_lock(&ra->mutex);
+
+    switch (origin) {
+        case SEEK_SET: pos = offset;           break;
+        case SEEK_CUR: pos = s->pos + offset;  break;
+        case SEEK_END: pos = s->size + offset; break;
+        default:       pos = -1;               break;
+    }
+
+    /* buffer is synchronized lazily at next read.
+     * This avoids flushing buffer when only file size is queried. */
+    if (pos >= 0) {
+        s->pos = pos;
+    }
+
+    bd_mutex_unlock(&ra->mutex);
+
+    return pos < 0 ? -1 : pos;
+}
+
+static int64_t _stream_tell(BD_FILE_H *fp)
+{
+    RA_STREAM *s = (RA_STREAM *)fp->internal;
+    return s->pos;
+}
+
+static void _stream_close(BD_FILE_H *fp)
+{
+    RA_STREAM    *s  = (RA_STREAM *)fp->internal;
+    BD_READAHEAD *ra = s->ra;
+    RA_STREAM   **p;
+
+    bd_mutex_lock(&ra->mutex);
+
+    while (ra->busy == s) {
+        bd_cond_wait(&ra->data_cond, &ra->mutex);
+    }
+
+    for (p = &ra->streams; *p; p = &(*p)->next) {
+        if (*p == s) {
+            *p = s->next;
+            break;
+        }
+    }
+
+    /* next stream may be filled now */
+    bd_cond_signal(&ra->work_cond);
+
+    bd_mutex_unlock(&ra->mutex);
+
+    BD_DEBUG(DBG_FILE, "Closed read-ahead stream (%p)\n", (void*)s);
+
+    file_close(s->fp);
+    X_FREE(s->buf);
+    X_FREE(s);
+    X_FREE(fp);
+}
+
+BD_FILE_H *readahead_open(BD_READAHEAD *ra, BD_FILE_H *fp, int64_t start_pos, int64_t end_pos)
+{
+    BD_FILE_H  *p;
+    RA_STREAM  *s;
+    RA_STREAM **tail;
+    int64_t     size;
+
+    size = file_size(fp);
+    if (size < 0) {
+        return NULL;
+    }
+
+    p = calloc(1, sizeof(BD_FILE_H));
+    s = calloc(1, sizeof(RA_STREAM));
+    if (!p || !s) {
+        goto error;
+    }
+    s->buf = malloc((size_t)ra->num_units * RA_UNIT);
+    if (!s->buf) {
+        goto error;
+    }
+
+    start_pos = (start_pos / RA_UNIT) * RA_UNIT;
+
+    s->ra         = ra;
+    s->fp         = fp;
+    s->fp_pos     = -1;
+    s->size       = size;
+    s->pos        = start_pos;
+    s->buf_pos    = start_pos;
+    s->fill_limit = end_pos > start_pos ? end_pos : size;
+
+    p->internal = s;
+    p->read     = _stream_read;
+    p->seek     = _stream_seek;
+    p->tell     = _stream_tell;
+    p->close    = _stream_close;
+
+    BD_DEBUG(DBG_FILE, "Opened read-ahead stream (%p), buffering %" PRId64 "-%" PRId64 "\n",
+             (void*)s, start_pos, s->fill_limit);
+
+    bd_mutex_lock(&ra->mutex);
+
+    for (tail = &ra->streams; *tail; tail = &(*tail)->next) ;
+    *tail = s;
+
+    bd_cond_signal(&ra->work_cond);
+
+    bd_mutex_unlock(&ra->mutex);
+
+    return p;
+
+ error:
+    BD_DEBUG(DBG_FILE | DBG_CRIT, "readahead_open(): out of memory\n");
+    if (s) {
+        X_FREE(s->buf);
+    }
+    X_FREE(s);
+    X_FREE(p);
+    return NULL;
+}
+
+/*
+ *
+ */
+
+BD_READAHEAD *readahead_init(unsigned num_units)
+{
+    BD_READAHEAD *ra;
+
+    if (num_units < 1) {
+        return NULL;
+    }
+
+    ra = calloc(1, sizeof(BD_READAHEAD));
+    if (!ra) {
+        return NULL;
+    }
+
+    ra->num_units = num_units;
+
+    if (bd_mutex_init(&ra->mutex) < 0) {
+        X_FREE(ra);
+        return NULL;
+    }
+    if (bd_cond_init(&ra->work_cond) < 0) {
+        goto error_work_cond;
+    }
+    if (bd_cond_init(&ra->data_cond) < 0) {
+        goto error_data_cond;
+    }
+    if (bd_thread_create(&ra->thread, _worker, ra) < 0) {
+        goto error_thread;
+    }
+
+    BD_DEBUG(DBG_FILE, "read-ahead started (%u units)\n", num_units);
+    return ra;
+
+ error_thread:
+    bd_cond_destroy(&ra->data_cond);
+ error_data_cond:
+    bd_cond_destroy(&ra->work_cond);
+ error_work_cond:
+    bd_mutex_destroy(&ra->mutex);
+    X_FREE(ra);
+    return NULL;
+}
+
+void readahead_free(BD_READAHEAD **pp)
+{
+    if (pp && *pp) {
+        BD_READAHEAD *ra = *pp;
+
+        bd_mutex_lock(&ra->mutex);
+        if (ra->streams) {
+            BD_DEBUG(DBG_FILE | DBG_CRIT, "readahead_free(): streams not closed\n");
+        }
+        ra->quit = 1;
+        bd_cond_signal(&ra->work_cond);
+        bd_mutex_unlock(&ra->mutex);
+
+        bd_thread_join(&ra->thread);
+
+        bd_cond_destroy(&ra->data_cond);
+        bd_cond_destroy(&ra->work_cond);
+        bd_mutex_destroy(&ra->mutex);
+
+        X_FREE(*pp);
+    }
+}
+
+unsigned readahead_num_units(BD_READAHEAD *ra)
+{
+    return ra->num_units;
+}
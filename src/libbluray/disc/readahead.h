@@ -0,0 +1,59 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(_BD_DISC_READAHEAD_H_)
+#define _BD_DISC_READAHEAD_H_
+
+/*
+ * Background read-ahead of aligned units.
+ *
+ * Streams are served by single worker thread in the order they were opened.
+ * Next stream is filled after current stream has been buffered up to its end limit.
+ * Stream with a blocked reader is filled first.
+ */
+
+#include "util/attributes.h"
+
+#include <stdint.h>
+
+struct bd_file_s;
+
+typedef struct bd_readahead BD_READAHEAD;
+
+/* returns NULL if threads are not supported */
+BD_PRIVATE BD_READAHEAD *readahead_init(unsigned num_units);
+/* all streams must be closed before calling readahead_free() */
+BD_PRIVATE void readahead_free(BD_READAHEAD **);
+
+BD_PRIVATE unsigned readahead_num_units(BD_READAHEAD *);
+
+/*
+ * Wrap stream. Returned stream takes ownership of fp.
+ * Reads must be multiple of aligned unit size (6144 bytes).
+ *
+ * fp is read from worker thread. It must not be a decrypting stream
+ * (AACS / BD+ handles are not thread-safe).
+ *
+ * start_pos: where to start buffering
+ * end_pos: buffer only up to this position (until stream is seeked past it)
+ */
+BD_PRIVATE struct bd_file_s *readahead_open(BD_READAHEAD *, struct bd_file_s *fp,
+                                            int64_t start_pos, int64_t end_pos);
+
+#endif /* _BD_DISC_READAHEAD_H_ */
@@ -148,8 +148,9 @@ BD_DIR_H *udf_dir_open(void *udf, const char* dirname)
 
 typedef struct {
     struct udfread_block_input i;
-    BD_FILE_H *fp;
-    BD_MUTEX mutex;
+    BD_FILE_H   *fp;
+    BD_FILE_EXT *ext;  /* set if fp was created by libbluray (positional reads) */
+    BD_MUTEX     mutex;
 } UDF_BI;
 
 static int _bi_close(struct udfread_block_input *bi_gen)
@@ -177,12 +178,22 @@ static int _bi_read(struct udfread_block_input *bi_gen, uint32_t lba, void *buf,
     UDF_BI *bi = (UDF_BI *)bi_gen;
     int got = -1;
     int64_t pos = (int64_t)lba * UDF_BLOCK_SIZE;
+    int64_t bytes;
+
+    /* positional read does not need locking */
+    if (bi->ext && bi->ext->read_at) {
+        bytes = file_read_at(bi->ext, (uint8_t*)buf, (size_t)nblocks * UDF_BLOCK_SIZE, pos);
+        if (bytes > 0) {
+            got = bytes / UDF_BLOCK_SIZE;
+        }
+        return got;
+    }
 
     /* seek + read must be atomic */
     bd_mutex_lock(&bi->mutex);
 
-    if (file_seek(bi->fp, SEEK_SET, pos) == pos) {
-        int64_t bytes = file_read(bi->fp, (uint8_t*)buf, (int64_t)nblocks * UDF_BLOCK_SIZE);
+    if (file_seek(bi->fp, pos, SEEK_SET) == pos) {
+        bytes = file_read(bi->fp, (uint8_t*)buf, (size_t)nblocks * UDF_BLOCK_SIZE);
         if (bytes > 0) {
             got = bytes / UDF_BLOCK_SIZE;
         }
@@ -193,13 +204,13 @@ static int _bi_read(struct udfread_block_input *bi_gen, uint32_t lba, void *buf,
     return got;
 }
 
-static struct udfread_block_input *_block_input(const char *img)
+static struct udfread_block_input *_block_input(BD_FILE_H *fp, BD_FILE_EXT *ext)
 {
-    BD_FILE_H *fp = file_open(img, "rb");
     if (fp) {
         UDF_BI *bi = calloc(1, sizeof(*bi));
         if (bi) {
             bi->fp      = fp;
+            bi->ext     = ext;
             bi->i.close = _bi_close;
             bi->i.read  = _bi_read;
             bi->i.size  = _bi_size;
@@ -246,7 +257,7 @@ static struct udfread_block_input *_stream_input(void *read_block_handle,
 }
 
 
-void *udf_image_open(const char *img_path,
+void *udf_image_open(const char *img_path, int use_mmap,
                      void *read_block_handle,
                      int (*read_blocks)(void *handle, void *buf, int lba, int num_blocks))
 {
@@ -267,15 +278,21 @@ void *udf_image_open(const char *img_path,
             }
         }
     } else {
+        struct udfread_block_input *bi;
+
+        if (file_open != file_open_default()) {
+            /* app handles file I/O. Application-provided BD_FILE_H is not BD_FILE_EXT. */
+            bi = _block_input(file_open(img_path, "rb"), NULL);
+        } else {
+            /* local image file (memory-mapped or positional reads) */
+            BD_FILE_EXT *ext = file_open_ext(img_path, use_mmap);
+            bi = ext ? _block_input(&ext->file, ext) : NULL;
+        }
 
-        /* app handles file I/O ? */
-        if (result < 0 && file_open != file_open_default()) {
-            struct udfread_block_input *bi = _block_input(img_path);
-            if (bi) {
-                result = udfread_open_input(udf, bi);
-                if (result < 0) {
-                    bi->close(bi);
-                }
+        if (bi) {
+            result = udfread_open_input(udf, bi);
+            if (result < 0) {
+                bi->close(bi);
             }
         }
 
@@ -25,7 +25,7 @@
 struct bd_file_s;
 struct bd_dir_s;
 
-BD_PRIVATE void *udf_image_open(const char *img_path,
+BD_PRIVATE void *udf_image_open(const char *img_path, int use_mmap,
                                 void *read_block_handle,
                                  int (*read_blocks)(void *handle, void *buf, int lba, int num_blocks));
 BD_PRIVATE void  udf_image_close(void *udf);
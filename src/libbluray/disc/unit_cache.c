@@ -0,0 +1,297 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "unit_cache.h"
+
+#include "util/logging.h"
+#include "util/macro.h"
+#include "util/mutex.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UNIT_SIZE       6144
+#define DISC_ID_SIZE    20
+#define MAX_BUCKETS     (1 << 20)
+
+typedef struct unit_entry UNIT_ENTRY;
+struct unit_entry {
+    UNIT_ENTRY *hash_next;
+    UNIT_ENTRY *lru_prev;   /* towards most recently used */
+    UNIT_ENTRY *lru_next;   /* towards least recently used */
+
+    uint8_t     disc_id[DISC_ID_SIZE];
+    uint64_t    file_id;
+    uint32_t    unit;
+
+    uint8_t     data[UNIT_SIZE];
+};
+
+struct bd_unit_cache {
+    BD_MUTEX     mutex;
+    unsigned     refcnt;     /* protected by global lock */
+
+    unsigned     max_units;
+    unsigned     num_units;
+
+    unsigned     hash_mask;
+    UNIT_ENTRY **hash;
+
+    UNIT_ENTRY  *lru_head;   /* most recently used */
+    UNIT_ENTRY  *lru_tail;   /* least recently used */
+
+    /* statistics */
+    uint64_t     hits;
+    uint64_t     misses;
+};
+
+static BD_UNIT_CACHE *shared_cache = NULL;
+
+/*
+ *
+ */
+
+static unsigned _hash(const uint8_t *disc_id, uint64_t file_id, uint32_t unit)
+{
+    uint64_t h = ((uint64_t)disc_id[0] << 24) | ((uint64_t)disc_id[1] << 16) | ((uint64_t)disc_id[2] << 8) | disc_id[3];
+    h ^= file_id ^ unit;
+    h *= UINT64_C(0x9e3779b97f4a7c15);
+    return (unsigned)(h >> 32);
+}
+
+static UNIT_ENTRY **_find(BD_UNIT_CACHE *p, const uint8_t *disc_id, uint64_t file_id, uint32_t unit)
+{
+    UNIT_ENTRY **pe = &p->hash[_hash(disc_id, file_id, unit) & p->hash_mask];
+
+    for (; *pe; pe = &(*pe)->hash_next) {
+        UNIT_ENTRY *e = *pe;
+        if (e->unit == unit && e->file_id == file_id && !memcmp(e->disc_id, disc_id, DISC_ID_SIZE)) {
+            break;
+        }
+    }
+
+    return pe;
+}
+
+static void _lru_unlink(BD_UNIT_CACHE *p, UNIT_ENTRY *e)
+{
+    if (e->lru_prev) {
+        e->lru_prev->lru_next = e->lru_next;
+    } else {
+        p->lru_head = e->lru_next;
+    }
+    if (e->lru_next) {
+        e->lru_next->lru_prev = e->lru_prev;
+    } else {
+        p->lru_tail = e->lru_prev;
+    }
+    e->lru_prev = e->lru_next = NULL;
+}
+
+static void _lru_push(BD_UNIT_CACHE *p, UNIT_ENTRY *e)
+{
+    e->lru_prev = NULL;
+    e->lru_next = p->lru_head;
+    if (p->lru_head) {
+        p->lru_head->lru_prev = e;
+    } else {
+        p->lru_tail = e;
+    }
+    p->lru_head = e;
+}
+
+/* remove least recently used entry from cache */
+static UNIT_ENTRY *_evict(BD_UNIT_CACHE *p)
+{
+    UNIT_ENTRY *e = p->lru_tail;
+    if (e) {
+        UNIT_ENTRY **pe = _find(p, e->disc_id, e->file_id, e->unit);
+        *pe = e->hash_next;
+        e->hash_next = NULL;
+        _lru_unlink(p, e);
+        p->num_units--;
+    }
+    return e;
+}
+
+/*
+ *
+ */
+
+static BD_UNIT_CACHE *_cache_new(unsigned max_units)
+{
+    BD_UNIT_CACHE *p;
+    unsigned num_buckets = 1024;
+
+    while (num_buckets < max_units && num_buckets < MAX_BUCKETS) {
+        num_buckets <<= 1;
+    }
+
+    p = calloc(1, sizeof(*p));
+    if (!p) {
+        return NULL;
+    }
+    p->hash = calloc(num_buckets, sizeof(*p->hash));
+    if (!p->hash) {
+        X_FREE(p);
+        return NULL;
+    }
+    if (bd_mutex_init(&p->mutex) < 0) {
+        X_FREE(p->hash);
+        X_FREE(p);
+        return NULL;
+    }
+
+    p->hash_mask = num_buckets - 1;
+    p->max_units = max_units;
+
+    return p;
+}
+
+static void _cache_free(BD_UNIT_CACHE *p)
+{
+    UNIT_ENTRY *e;
+
+    BD_DEBUG(DBG_BLURAY, "unit cache: %" PRIu64 " hits, %" PRIu64 " misses\n", p->hits, p->misses);
+
+    while ((e = _evict(p))) {
+        X_FREE(e);
+    }
+
+    bd_mutex_destroy(&p->mutex);
+    X_FREE(p->hash);
+    X_FREE(p);
+}
+
+BD_UNIT_CACHE *unit_cache_get(unsigned max_units)
+{
+    BD_UNIT_CACHE *p;
+
+    if (!max_units) {
+        return NULL;
+    }
+
+    bd_global_lock();
+
+    if (!shared_cache) {
+        shared_cache = _cache_new(max_units);
+        if (shared_cache) {
+            BD_DEBUG(DBG_BLURAY, "unit cache: created (%u units)\n", max_units);
+        }
+    } else if (shared_cache->max_units < max_units) {
+        bd_mutex_lock(&shared_cache->mutex);
+        shared_cache->max_units = max_units;
+        bd_mutex_unlock(&shared_cache->mutex);
+        BD_DEBUG(DBG_BLURAY, "unit cache: resized (%u units)\n", max_units);
+    }
+
+    p = shared_cache;
+    if (p) {
+        p->refcnt++;
+    }
+
+    bd_global_unlock();
+
+    return p;
+}
+
+void unit_cache_release(BD_UNIT_CACHE **pp)
+{
+    if (pp && *pp) {
+        bd_global_lock();
+
+        if (--(*pp)->refcnt == 0) {
+            _cache_free(*pp);
+            shared_cache = NULL;
+        }
+
+        bd_global_unlock();
+
+        *pp = NULL;
+    }
+}
+
+int unit_cache_lookup(BD_UNIT_CACHE *p, const uint8_t *disc_id, uint64_t file_id, uint32_t unit, uint8_t *buf)
+{
+    UNIT_ENTRY *e;
+
+    bd_mutex_lock(&p->mutex);
+
+    e = *_find(p, disc_id, file_id, unit);
+    if (e) {
+        memcpy(buf, e->data, UNIT_SIZE);
+        _lru_unlink(p, e);
+        _lru_push(p, e);
+        p->hits++;
+    } else {
+        p->misses++;
+    }
+
+    bd_mutex_unlock(&p->mutex);
+
+    return !!e;
+}
+
+void unit_cache_insert(BD_UNIT_CACHE *p, const uint8_t *disc_id, uint64_t file_id, uint32_t unit, const uint8_t *buf)
+{
+    UNIT_ENTRY **pe, *e;
+
+    bd_mutex_lock(&p->mutex);
+
+    pe = _find(p, disc_id, file_id, unit);
+    if (*pe) {
+        /* already cached (another reader) */
+        e = *pe;
+        _lru_unlink(p, e);
+        _lru_push(p, e);
+        bd_mutex_unlock(&p->mutex);
+        return;
+    }
+
+    /* re-use oldest entry if cache is full */
+    e = NULL;
+    if (p->num_units >= p->max_units) {
+        e = _evict(p);
+        pe = _find(p, disc_id, file_id, unit);
+    }
+    if (!e) {
+        e = malloc(sizeof(*e));
+        if (!e) {
+            bd_mutex_unlock(&p->mutex);
+            return;
+        }
+    }
+
+    memcpy(e->disc_id, disc_id, DISC_ID_SIZE);
+    e->file_id = file_id;
+    e->unit    = unit;
+    memcpy(e->data, buf, UNIT_SIZE);
+
+    e->hash_next = NULL;
+    *pe = e;
+    _lru_push(p, e);
+    p->num_units++;
+
+    bd_mutex_unlock(&p->mutex);
+}
@@ -0,0 +1,45 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(_BD_DISC_UNIT_CACHE_H_)
+#define _BD_DISC_UNIT_CACHE_H_
+
+/*
+ * Process-wide LRU cache of decrypted 6144-byte aligned units.
+ *
+ * Shared by all BLURAY instances. Units are identified by
+ * (disc id, file id, unit index). File id is hash of file path
+ * (same clip id is used by .m2ts and .ssif files).
+ */
+
+#include "util/attributes.h"
+
+#include <stdint.h>
+
+typedef struct bd_unit_cache BD_UNIT_CACHE;
+
+/* get reference to shared cache. Cache size is the largest requested size. */
+BD_PRIVATE BD_UNIT_CACHE *unit_cache_get(unsigned max_units);
+BD_PRIVATE void           unit_cache_release(BD_UNIT_CACHE **);
+
+/* returns 1 if unit was found and copied to buf */
+BD_PRIVATE int  unit_cache_lookup(BD_UNIT_CACHE *, const uint8_t *disc_id, uint64_t file_id, uint32_t unit, uint8_t *buf);
+BD_PRIVATE void unit_cache_insert(BD_UNIT_CACHE *, const uint8_t *disc_id, uint64_t file_id, uint32_t unit, const uint8_t *buf);
+
+#endif /* _BD_DISC_UNIT_CACHE_H_ */
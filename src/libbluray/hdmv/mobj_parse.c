@@ -125,7 +125,7 @@ void mobj_free(MOBJ_OBJECTS **p)
     }
 }
 
-static MOBJ_OBJECTS *_mobj_parse(BD_FILE_H *fp)
+static MOBJ_OBJECTS *_mobj_parse(const uint8_t *data, size_t size)
 {
     BITSTREAM     bs;
     MOBJ_OBJECTS *objects = NULL;
@@ -133,11 +133,13 @@ static MOBJ_OBJECTS *_mobj_parse(BD_FILE_H *fp)
     uint32_t      data_len;
     int           extension_data_start, i;
 
-    if (bs_init(&bs, fp) < 0) {
+    if (!data || !size) {
         BD_DEBUG(DBG_NAV, "MovieObject.bdmv: read error\n");
         goto error;
     }
 
+    bs_init_mem(&bs, data, size);
+
     objects = calloc(1, sizeof(MOBJ_OBJECTS));
     if (!objects) {
         BD_DEBUG(DBG_CRIT, "out of memory\n");
@@ -193,6 +195,8 @@ MOBJ_OBJECTS *mobj_parse(const char *file_name)
 {
     BD_FILE_H    *fp;
     MOBJ_OBJECTS *objects;
+    uint8_t      *data;
+    size_t        size;
 
     fp = file_open(file_name, "rb");
     if (!fp) {
@@ -200,23 +204,27 @@ MOBJ_OBJECTS *mobj_parse(const char *file_name)
         return NULL;
     }
 
-    objects = _mobj_parse(fp);
+    size = file_read_all(fp, &data);
     file_close(fp);
+
+    objects = _mobj_parse(data, size);
+    X_FREE(data);
     return objects;
 }
 
 static MOBJ_OBJECTS *_mobj_get(BD_DISC *disc, const char *path)
 {
-    BD_FILE_H    *fp;
     MOBJ_OBJECTS *objects;
+    uint8_t      *data;
+    size_t        size;
 
-    fp = disc_open_path(disc, path);
-    if (!fp) {
+    size = disc_read_file(disc, NULL, path, &data);
+    if (!size) {
         return NULL;
     }
 
-    objects = _mobj_parse(fp);
-    file_close(fp);
+    objects = _mobj_parse(data, size);
+    X_FREE(data);
     return objects;
 }
 
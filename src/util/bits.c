@@ -83,6 +83,21 @@ int bs_init( BITSTREAM *bs, BD_FILE_H *fp )
     return _bs_read(bs);
 }
 
+void bs_init_mem( BITSTREAM *bs, const uint8_t *p_data, size_t i_data )
+{
+    bs->fp = NULL;
+    bs->pos = 0;
+    bs->end = (int64_t)i_data;
+    bs->size = i_data;
+    bb_init(&bs->bb, p_data, i_data);
+}
+
+/* true if buffer already holds everything up to end of file */
+static inline int _bs_buffered_to_end( const BITSTREAM *bs )
+{
+    return bs->pos + (int64_t)bs->size >= bs->end;
+}
+
 #if 0
 void bb_seek( BITBUFFER *bb, int64_t off, int whence)
 {
@@ -134,7 +149,15 @@ static int _bs_seek( BITSTREAM *bs, int64_t off, int whence)
     }
 
     b = off >> 3;
-    if (b >= bs->end)
+    if (!bs->fp) {
+        /* whole file in memory */
+        if (b >= bs->end) {
+            bs->bb.p = bs->bb.p_end;
+        } else {
+            bs->bb.p = &bs->bb.p_start[b];
+            bs->bb.i_left = 8 - (off & 0x07);
+        }
+    } else if (b >= bs->end)
     {
         int64_t pos;
         if (BF_BUF_SIZE < bs->end) {
@@ -184,6 +207,21 @@ uint32_t bb_read( BITBUFFER *bb, int i_count )
     int      i_shr;
     uint32_t i_result = 0;
 
+    if( i_count > 0 && i_count <= 32 && bb->p_end - bb->p >= 8 ) {
+        /* load 64 bits at once. Current byte has at least 1 unread bit, so 39 bits max are needed. */
+        const uint8_t *p = bb->p;
+        uint64_t w = ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) |
+                     ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32) |
+                     ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) |
+                     ((uint64_t)p[6] <<  8) |  (uint64_t)p[7];
+        int i_used = 8 - bb->i_left + i_count;
+
+        i_result = (uint32_t)((w << (8 - bb->i_left)) >> (64 - i_count));
+        bb->p     += i_used >> 3;
+        bb->i_left = 8 - (i_used & 0x07);
+        return( i_result );
+    }
+
     while( i_count > 0 ) {
 
         if( bb->p >= bb->p_end ) {
@@ -217,7 +255,7 @@ uint32_t bs_read( BITSTREAM *bs, int i_count )
     int left;
     int bytes = (i_count + 7) >> 3;
 
-    if (bs->bb.p + bytes >= bs->bb.p_end) {
+    if (bs->bb.p + bytes >= bs->bb.p_end && !_bs_buffered_to_end(bs)) {
         bs->pos = bs->pos + (bs->bb.p - bs->bb.p_start);
         left = bs->bb.i_left;
         file_seek(bs->fp, bs->pos, SEEK_SET);
@@ -244,7 +282,7 @@ void bs_skip( BITSTREAM *bs, size_t i_count )
     int left;
     size_t bytes = (i_count + 7) >> 3;
 
-    if (bs->bb.p + bytes >= bs->bb.p_end) {
+    if (bs->bb.p + bytes >= bs->bb.p_end && !_bs_buffered_to_end(bs)) {
         bs->pos = bs->pos + (bs->bb.p - bs->bb.p_start);
         left = bs->bb.i_left;
         file_seek(bs->fp, bs->pos, SEEK_SET);
@@ -28,6 +28,7 @@
 
 #include <stdint.h>
 #include <stddef.h>    // size_t
+#include <string.h>    // memcpy
 
 
 /**
@@ -46,7 +47,7 @@ typedef struct {
 } BITBUFFER;
 
 typedef struct {
-    BD_FILE_H *fp;
+    BD_FILE_H *fp;    /* NULL when whole file is in memory (bs_init_mem) */
     uint8_t    buf[BF_BUF_SIZE];
     BITBUFFER  bb;
     int64_t    pos;   /* file offset of buffer start (buf[0]) */
@@ -56,6 +57,7 @@ typedef struct {
 
 BD_PRIVATE void bb_init( BITBUFFER *bb, const uint8_t *p_data, size_t i_data );
 BD_PRIVATE int  bs_init( BITSTREAM *bs, BD_FILE_H *fp ) BD_USED;
+BD_PRIVATE void bs_init_mem( BITSTREAM *bs, const uint8_t *p_data, size_t i_data ); /* data must stay valid while parsing */
 //BD_PRIVATE void bb_seek( BITBUFFER *bb, int64_t off, int whence);
 //BD_PRIVATE void bs_seek( BITSTREAM *bs, int64_t off, int whence);
 //BD_PRIVATE void bb_seek_byte( BITBUFFER *bb, int64_t off);
@@ -100,6 +102,12 @@ static inline void bb_read_bytes( BITBUFFER *bb, uint8_t *buf, int i_count )
 {
     int ii;
 
+    if (bb->i_left == 8 && i_count > 0 && bb->p_end - bb->p >= i_count) {
+        memcpy(buf, bb->p, i_count);
+        bb->p += i_count;
+        return;
+    }
+
     for (ii = 0; ii < i_count; ii++) {
         buf[ii] = bb_read(bb, 8);
     }
@@ -109,6 +117,12 @@ static inline void bs_read_bytes( BITSTREAM *s, uint8_t *buf, int i_count )
 {
     int ii;
 
+    /* no buffer refill needed ? */
+    if (s->bb.p_end - s->bb.p > i_count) {
+        bb_read_bytes(&s->bb, buf, i_count);
+        return;
+    }
+
     for (ii = 0; ii < i_count; ii++) {
         buf[ii] = bs_read(s, 8);
     }
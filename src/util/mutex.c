@@ -165,3 +165,236 @@ int bd_mutex_destroy(BD_MUTEX *p)
     X_FREE(p->impl);
     return 0;
 }
+
+/*
+ * global lock
+ */
+
+#if defined(_WIN32)
+
+static CRITICAL_SECTION g_lock;
+static volatile LONG    g_lock_state; /* 0 - not initialized, 1 - initializing, 2 - ready */
+
+static void _global_init(void)
+{
+    while (g_lock_state != 2) {
+        if (InterlockedCompareExchange(&g_lock_state, 1, 0) == 0) {
+            InitializeCriticalSection(&g_lock);
+            InterlockedExchange(&g_lock_state, 2);
+        } else {
+            Sleep(0);
+        }
+    }
+}
+
+void bd_global_lock(void)
+{
+    _global_init();
+    EnterCriticalSection(&g_lock);
+}
+
+void bd_global_unlock(void)
+{
+    LeaveCriticalSection(&g_lock);
+}
+
+#else
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void bd_global_lock(void)
+{
+    if (pthread_mutex_lock(&g_lock)) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "bd_global_lock() failed !\n");
+    }
+}
+
+void bd_global_unlock(void)
+{
+    if (pthread_mutex_unlock(&g_lock)) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "bd_global_unlock() failed !\n");
+    }
+}
+
+#endif
+
+/*
+ * condition variable
+ */
+
+#if defined(_WIN32)
+
+/* Condition variables are available in Windows Vista and later.
+ * Functions are looked up at run time to keep Windows XP support. */
+
+typedef struct {
+    void *ptr;  /* binary compatible with CONDITION_VARIABLE */
+} COND_IMPL;
+
+typedef VOID (WINAPI *fptr_cond)(COND_IMPL *);
+typedef BOOL (WINAPI *fptr_cond_sleep)(COND_IMPL *, CRITICAL_SECTION *, DWORD);
+
+static int             g_cond_loaded; /* 0 - not loaded, 1 - available, -1 - not available */
+static fptr_cond       g_cond_init;
+static fptr_cond       g_cond_wake;
+static fptr_cond       g_cond_wake_all;
+static fptr_cond_sleep g_cond_sleep;
+
+static int _cond_load(void)
+{
+    int result;
+
+    bd_global_lock();
+
+    if (!g_cond_loaded) {
+        HMODULE h = GetModuleHandle(TEXT("kernel32.dll"));
+        if (h) {
+            *(void **)(&g_cond_init)     = (void *)GetProcAddress(h, "InitializeConditionVariable");
+            *(void **)(&g_cond_wake)     = (void *)GetProcAddress(h, "WakeConditionVariable");
+            *(void **)(&g_cond_wake_all) = (void *)GetProcAddress(h, "WakeAllConditionVariable");
+            *(void **)(&g_cond_sleep)    = (void *)GetProcAddress(h, "SleepConditionVariableCS");
+        }
+        g_cond_loaded = (g_cond_init && g_cond_wake && g_cond_wake_all && g_cond_sleep) ? 1 : -1;
+    }
+    result = g_cond_loaded > 0;
+
+    bd_global_unlock();
+
+    return result;
+}
+
+int bd_cond_init(BD_COND *p)
+{
+    p->impl = NULL;
+
+    if (!_cond_load()) {
+        BD_DEBUG(DBG_BLURAY, "bd_cond_init(): condition variables not supported\n");
+        return -1;
+    }
+
+    p->impl = calloc(1, sizeof(COND_IMPL));
+    if (!p->impl) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "bd_cond_init() failed !\n");
+        return -1;
+    }
+
+    g_cond_init((COND_IMPL*)p->impl);
+    return 0;
+}
+
+int bd_cond_destroy(BD_COND *p)
+{
+    if (!p->impl) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "bd_cond_destroy() failed !\n");
+        return -1;
+    }
+
+    /* nothing to release */
+    X_FREE(p->impl);
+    return 0;
+}
+
+int bd_cond_wait(BD_COND *p, BD_MUTEX *m)
+{
+    if (!p->impl || !m->impl) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "bd_cond_wait() failed !\n");
+        return -1;
+    }
+
+    if (!g_cond_sleep((COND_IMPL*)p->impl, &((MUTEX_IMPL*)m->impl)->cs, INFINITE)) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "SleepConditionVariableCS() failed !\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int bd_cond_signal(BD_COND *p)
+{
+    if (!p->impl) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "bd_cond_signal() failed !\n");
+        return -1;
+    }
+    g_cond_wake((COND_IMPL*)p->impl);
+    return 0;
+}
+
+int bd_cond_broadcast(BD_COND *p)
+{
+    if (!p->impl) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "bd_cond_broadcast() failed !\n");
+        return -1;
+    }
+    g_cond_wake_all((COND_IMPL*)p->impl);
+    return 0;
+}
+
+#elif defined(HAVE_PTHREAD_H)
+
+int bd_cond_init(BD_COND *p)
+{
+    p->impl = calloc(1, sizeof(pthread_cond_t));
+    if (!p->impl) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "bd_cond_init() failed !\n");
+        return -1;
+    }
+
+    if (pthread_cond_init((pthread_cond_t*)p->impl, NULL)) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "pthread_cond_init() failed !\n");
+        X_FREE(p->impl);
+        return -1;
+    }
+
+    return 0;
+}
+
+int bd_cond_destroy(BD_COND *p)
+{
+    if (!p->impl) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "bd_cond_destroy() failed !\n");
+        return -1;
+    }
+
+    if (pthread_cond_destroy((pthread_cond_t*)p->impl)) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "pthread_cond_destroy() failed !\n");
+        return -1;
+    }
+
+    X_FREE(p->impl);
+    return 0;
+}
+
+int bd_cond_wait(BD_COND *p, BD_MUTEX *m)
+{
+    if (!p->impl || !m->impl) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "bd_cond_wait() failed !\n");
+        return -1;
+    }
+
+    if (pthread_cond_wait((pthread_cond_t*)p->impl, (MUTEX_IMPL*)m->impl)) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "pthread_cond_wait() failed !\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int bd_cond_signal(BD_COND *p)
+{
+    if (!p->impl) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "bd_cond_signal() failed !\n");
+        return -1;
+    }
+    return pthread_cond_signal((pthread_cond_t*)p->impl) ? -1 : 0;
+}
+
+int bd_cond_broadcast(BD_COND *p)
+{
+    if (!p->impl) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "bd_cond_broadcast() failed !\n");
+        return -1;
+    }
+    return pthread_cond_broadcast((pthread_cond_t*)p->impl) ? -1 : 0;
+}
+
+#endif /* HAVE_PTHREAD_H */
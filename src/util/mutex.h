@@ -37,4 +37,33 @@ BD_PRIVATE int bd_mutex_destroy(BD_MUTEX *p);
 BD_PRIVATE int bd_mutex_lock(BD_MUTEX *p);
 BD_PRIVATE int bd_mutex_unlock(BD_MUTEX *p);
 
+/*
+ * global (process-wide, non-recursive) lock
+ *
+ * Used to protect shared objects that are not owned by any BLURAY instance.
+ * Does not need initialization.
+ */
+
+BD_PRIVATE void bd_global_lock(void);
+BD_PRIVATE void bd_global_unlock(void);
+
+/*
+ * condition variable
+ *
+ * Mutex must be locked exactly once when calling bd_cond_wait().
+ * Not available in all platforms (bd_cond_init() fails).
+ */
+
+typedef struct bd_cond_s BD_COND;
+struct bd_cond_s {
+    void *impl;
+};
+
+BD_PRIVATE int bd_cond_init(BD_COND *p);
+BD_PRIVATE int bd_cond_destroy(BD_COND *p);
+
+BD_PRIVATE int bd_cond_wait(BD_COND *p, BD_MUTEX *m);
+BD_PRIVATE int bd_cond_signal(BD_COND *p);
+BD_PRIVATE int bd_cond_broadcast(BD_COND *p);
+
 #endif // LIBBLURAY_MUTEX_H_
@@ -0,0 +1,373 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "thread.h"
+
+#include "logging.h"
+#include "macro.h"
+#include "mutex.h"
+
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#   include <windows.h>
+#   include <process.h>
+#elif defined(HAVE_PTHREAD_H)
+#   include <pthread.h>
+#endif
+
+
+#if defined(_WIN32)
+
+typedef struct {
+    HANDLE  handle;
+    void *(*func)(void *);
+    void   *arg;
+} THREAD_IMPL;
+
+static unsigned __stdcall _thread_main(void *arg)
+{
+    THREAD_IMPL *t = (THREAD_IMPL *)arg;
+    t->func(t->arg);
+    return 0;
+}
+
+int bd_thread_create(BD_THREAD *p, void *(*func)(void *), void *arg)
+{
+    THREAD_IMPL *t = calloc(1, sizeof(THREAD_IMPL));
+    if (!t) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "bd_thread_create() failed !\n");
+        return -1;
+    }
+
+    t->func = func;
+    t->arg  = arg;
+
+    t->handle = (HANDLE)_beginthreadex(NULL, 0, _thread_main, t, 0, NULL);
+    if (!t->handle) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "_beginthreadex() failed !\n");
+        X_FREE(t);
+        return -1;
+    }
+
+    p->impl = t;
+    return 0;
+}
+
+int bd_thread_join(BD_THREAD *p)
+{
+    THREAD_IMPL *t = (THREAD_IMPL *)p->impl;
+
+    if (!t) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "bd_thread_join() failed !\n");
+        return -1;
+    }
+
+    if (WaitForSingleObject(t->handle, INFINITE) != WAIT_OBJECT_0) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "WaitForSingleObject() failed !\n");
+        return -1;
+    }
+
+    CloseHandle(t->handle);
+    X_FREE(p->impl);
+    return 0;
+}
+
+#elif defined(HAVE_PTHREAD_H)
+
+int bd_thread_create(BD_THREAD *p, void *(*func)(void *), void *arg)
+{
+    p->impl = calloc(1, sizeof(pthread_t));
+    if (!p->impl) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "bd_thread_create() failed !\n");
+        return -1;
+    }
+
+    if (pthread_create((pthread_t*)p->impl, NULL, func, arg)) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "pthread_create() failed !\n");
+        X_FREE(p->impl);
+        return -1;
+    }
+
+    return 0;
+}
+
+int bd_thread_join(BD_THREAD *p)
+{
+    if (!p->impl) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "bd_thread_join() failed !\n");
+        return -1;
+    }
+
+    if (pthread_join(*(pthread_t*)p->impl, NULL)) {
+        BD_DEBUG(DBG_BLURAY|DBG_CRIT, "pthread_join() failed !\n");
+        return -1;
+    }
+
+    X_FREE(p->impl);
+    return 0;
+}
+
+#else
+
+int bd_thread_create(BD_THREAD *p, void *(*func)(void *), void *arg)
+{
+    (void)func;
+    (void)arg;
+    p->impl = NULL;
+    BD_DEBUG(DBG_BLURAY, "bd_thread_create(): threads not supported\n");
+    return -1;
+}
+
+int bd_thread_join(BD_THREAD *p)
+{
+    (void)p;
+    return -1;
+}
+
+#endif
+
+int bd_thread_supported(void)
+{
+#if defined(_WIN32) || defined(HAVE_PTHREAD_H)
+    /* condition variables are not available in all Windows versions */
+    BD_COND cond;
+    if (bd_cond_init(&cond) < 0) {
+        return 0;
+    }
+    bd_cond_destroy(&cond);
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+
+/*
+ * worker pool
+ */
+
+#define POOL_MAX_THREADS 64
+
+struct bd_thread_pool_s {
+    BD_MUTEX  run_mutex;   /* serializes bd_thread_pool_run() and thread changes */
+    BD_MUTEX  mutex;       /* protects job state */
+    BD_COND   work_cond;
+    BD_COND   done_cond;
+
+    /* current job */
+    void    (*func)(void *, unsigned);
+    void     *arg;
+    unsigned  count;
+    unsigned  next;        /* next index to process */
+    unsigned  pending;     /* calls not yet completed */
+
+    int       exit;
+
+    unsigned  num_threads;
+    BD_THREAD threads[POOL_MAX_THREADS];
+};
+
+/* called with p->mutex locked */
+static void _pool_process(BD_THREAD_POOL *p)
+{
+    while (p->next < p->count) {
+        unsigned idx = p->next++;
+
+        bd_mutex_unlock(&p->mutex);
+        p->func(p->arg, idx);
+        bd_mutex_lock(&p->mutex);
+
+        if (--p->pending == 0) {
+            bd_cond_signal(&p->done_cond);
+        }
+    }
+}
+
+static void *_pool_worker(void *arg)
+{
+    BD_THREAD_POOL *p = (BD_THREAD_POOL *)arg;
+
+    bd_mutex_lock(&p->mutex);
+    while (!p->exit) {
+        if (p->next < p->count) {
+            _pool_process(p);
+        } else {
+            bd_cond_wait(&p->work_cond, &p->mutex);
+        }
+    }
+    bd_mutex_unlock(&p->mutex);
+
+    return NULL;
+}
+
+static void _pool_stop(BD_THREAD_POOL *p)
+{
+    unsigned ii;
+
+    bd_mutex_lock(&p->mutex);
+    p->exit = 1;
+    bd_cond_broadcast(&p->work_cond);
+    bd_mutex_unlock(&p->mutex);
+
+    for (ii = 0; ii < p->num_threads; ii++) {
+        bd_thread_join(&p->threads[ii]);
+    }
+    p->num_threads = 0;
+    p->exit = 0;
+}
+
+BD_THREAD_POOL *bd_thread_pool_init(void)
+{
+    BD_THREAD_POOL *p = calloc(1, sizeof(*p));
+    if (!p) {
+        return NULL;
+    }
+
+    if (bd_mutex_init(&p->run_mutex) < 0) {
+        goto error_run_mutex;
+    }
+    if (bd_mutex_init(&p->mutex) < 0) {
+        goto error_mutex;
+    }
+    if (bd_cond_init(&p->work_cond) < 0) {
+        goto error_work_cond;
+    }
+    if (bd_cond_init(&p->done_cond) < 0) {
+        goto error_done_cond;
+    }
+
+    return p;
+
+ error_done_cond:
+    bd_cond_destroy(&p->work_cond);
+ error_work_cond:
+    bd_mutex_destroy(&p->mutex);
+ error_mutex:
+    bd_mutex_destroy(&p->run_mutex);
+ error_run_mutex:
+    X_FREE(p);
+    return NULL;
+}
+
+void bd_thread_pool_free(BD_THREAD_POOL **pp)
+{
+    if (pp && *pp) {
+        BD_THREAD_POOL *p = *pp;
+
+        bd_mutex_lock(&p->run_mutex);
+        _pool_stop(p);
+        bd_mutex_unlock(&p->run_mutex);
+
+        bd_cond_destroy(&p->done_cond);
+        bd_cond_destroy(&p->work_cond);
+        bd_mutex_destroy(&p->mutex);
+        bd_mutex_destroy(&p->run_mutex);
+
+        X_FREE(*pp);
+    }
+}
+
+unsigned bd_thread_pool_set_threads(BD_THREAD_POOL *p, unsigned num_threads)
+{
+    if (!p) {
+        return 0;
+    }
+
+    num_threads = BD_MIN(num_threads, POOL_MAX_THREADS);
+
+    bd_mutex_lock(&p->run_mutex);
+
+    if (num_threads != p->num_threads) {
+        _pool_stop(p);
+
+        while (p->num_threads < num_threads) {
+            if (bd_thread_create(&p->threads[p->num_threads], _pool_worker, p) < 0) {
+                break;
+            }
+            p->num_threads++;
+        }
+
+        BD_DEBUG(DBG_BLURAY, "Worker pool: %u threads\n", p->num_threads);
+    }
+
+    num_threads = p->num_threads;
+
+    bd_mutex_unlock(&p->run_mutex);
+
+    return num_threads;
+}
+
+unsigned bd_thread_pool_num_threads(BD_THREAD_POOL *p)
+{
+    unsigned num_threads = 0;
+
+    if (p) {
+        bd_mutex_lock(&p->run_mutex);
+        num_threads = p->num_threads;
+        bd_mutex_unlock(&p->run_mutex);
+    }
+
+    return num_threads;
+}
+
+void bd_thread_pool_run(BD_THREAD_POOL *p,
+                        void (*func)(void *arg, unsigned idx), void *arg,
+                        unsigned count)
+{
+    unsigned ii;
+
+    if (p) {
+        bd_mutex_lock(&p->run_mutex);
+
+        if (p->num_threads > 0 && count > 1) {
+            bd_mutex_lock(&p->mutex);
+
+            p->func    = func;
+            p->arg     = arg;
+            p->count   = count;
+            p->next    = 0;
+            p->pending = count;
+            bd_cond_broadcast(&p->work_cond);
+
+            _pool_process(p);
+            while (p->pending > 0) {
+                bd_cond_wait(&p->done_cond, &p->mutex);
+            }
+
+            p->count = p->next = 0;
+            p->func  = NULL;
+            p->arg   = NULL;
+
+            bd_mutex_unlock(&p->mutex);
+            bd_mutex_unlock(&p->run_mutex);
+            return;
+        }
+
+        bd_mutex_unlock(&p->run_mutex);
+    }
+
+    for (ii = 0; ii < count; ii++) {
+        func(arg, ii);
+    }
+}
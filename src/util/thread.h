@@ -0,0 +1,64 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBBLURAY_THREAD_H_
+#define LIBBLURAY_THREAD_H_
+
+#include "attributes.h"
+
+/*
+ * worker threads
+ *
+ * Threads are optional: when bd_thread_create() fails,
+ * caller should fall back to synchronous operation.
+ */
+
+typedef struct bd_thread_s BD_THREAD;
+struct bd_thread_s {
+    void *impl;
+};
+
+BD_PRIVATE int bd_thread_create(BD_THREAD *p, void *(*func)(void *), void *arg);
+BD_PRIVATE int bd_thread_join(BD_THREAD *p);
+
+/* check if worker threads (and condition variables) are available */
+BD_PRIVATE int bd_thread_supported(void);
+
+/*
+ * worker pool
+ *
+ * bd_thread_pool_run() calls func(arg, 0 ... count-1) and returns when all
+ * calls have been completed. Calling thread participates in the work.
+ * Without worker threads (or with NULL pool) all calls are made from the
+ * calling thread.
+ */
+
+typedef struct bd_thread_pool_s BD_THREAD_POOL;
+
+BD_PRIVATE BD_THREAD_POOL *bd_thread_pool_init(void);
+BD_PRIVATE void bd_thread_pool_free(BD_THREAD_POOL **p);
+
+BD_PRIVATE unsigned bd_thread_pool_set_threads(BD_THREAD_POOL *p, unsigned num_threads);
+BD_PRIVATE unsigned bd_thread_pool_num_threads(BD_THREAD_POOL *p);
+
+BD_PRIVATE void bd_thread_pool_run(BD_THREAD_POOL *p,
+                                   void (*func)(void *arg, unsigned idx), void *arg,
+                                   unsigned count);
+
+#endif // LIBBLURAY_THREAD_H_
@@ -0,0 +1,206 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Parallel AACS decryption (dec_set_threads() > 1) must produce the same
+ * data as decrypting in the reading thread.
+ * Uses fake libaacs (LIBAACS_PATH) that fails if a handle is used concurrently.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "disc/dec.h"
+#include "disc/enc_info.h"
+#include "file/file.h"
+#include "util/thread.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_FILE  "dec_test.tmp"
+#define UNIT       6144
+#define NUM_UNITS  512
+#define MAX_READ   64
+#define TITLE      3
+
+static uint8_t plain[NUM_UNITS * UNIT];
+
+static uint32_t _rand(uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+/* same as in fake_libaacs.c */
+static void _crypt_unit(uint8_t *buf, uint32_t title)
+{
+    unsigned ii;
+
+    for (ii = 16; ii < 6144; ii++) {
+        buf[ii] ^= (uint8_t)(buf[ii % 16] + ii + title);
+    }
+}
+
+static int _create_file(void)
+{
+    uint8_t  buf[UNIT];
+    uint32_t seed = 1;
+    unsigned ii, jj;
+    FILE    *f = fopen(TEST_FILE, "wb");
+
+    if (!f) {
+        return -1;
+    }
+    for (ii = 0; ii < NUM_UNITS; ii++) {
+        uint8_t *p = plain + (size_t)ii * UNIT;
+        for (jj = 0; jj < UNIT; jj++) {
+            p[jj] = (uint8_t)_rand(&seed);
+        }
+        for (jj = 0; jj < UNIT; jj += 192) {
+            p[jj] &= ~0xc0;
+        }
+
+        /* set copy permission indicator */
+        memcpy(buf, p, UNIT);
+        for (jj = 0; jj < UNIT; jj += 192) {
+            buf[jj] |= 0xc0;
+        }
+        _crypt_unit(buf, TITLE);
+
+        if (fwrite(buf, 1, UNIT, f) != UNIT) {
+            fclose(f);
+            return -1;
+        }
+    }
+    return fclose(f) ? -1 : 0;
+}
+
+/* AACS detection: report all files as existing */
+static BD_FILE_H *_open_bdrom(void *handle, const char *path)
+{
+    (void)handle;
+    if (strstr(path, "Unit_Key_RO.inf")) {
+        return file_open(TEST_FILE, "rb");
+    }
+    return NULL;
+}
+
+/* read whole file with random read sizes and compare to plain text */
+static int _check(BD_DEC *dec, uint32_t seed)
+{
+    static uint8_t buf[MAX_READ * UNIT];
+    BD_FILE_H *fp;
+    int64_t    pos = 0;
+    int        result = -1;
+
+    fp = dec_open_stream(dec, file_open(TEST_FILE, "rb"), 0, "BDMV/STREAM/00000.m2ts");
+    if (!fp) {
+        fprintf(stderr, "dec_open_stream() failed\n");
+        return -1;
+    }
+
+    while (pos < (int64_t)NUM_UNITS * UNIT) {
+        int64_t size = (int64_t)(1 + _rand(&seed) % MAX_READ) * UNIT;
+        int64_t got  = file_read(fp, buf, size);
+
+        if (got <= 0 || got % UNIT) {
+            fprintf(stderr, "read at %lld failed\n", (long long)pos);
+            goto out;
+        }
+        if (memcmp(buf, plain + pos, (size_t)got)) {
+            fprintf(stderr, "data mismatch at %lld\n", (long long)pos);
+            goto out;
+        }
+        pos += got;
+    }
+
+    result = 0;
+
+ out:
+    file_close(fp);
+    return result;
+}
+
+int main(void)
+{
+    BD_ENC_INFO    enc_info;
+    BD_DEC        *dec;
+    struct dec_dev dev;
+    unsigned       threads;
+    int            result = 1;
+
+    if (!bd_thread_supported()) {
+        fprintf(stderr, "threads not supported\n");
+        return 77;
+    }
+    if (!getenv("LIBAACS_PATH")) {
+        fprintf(stderr, "LIBAACS_PATH not set\n");
+        return 77;
+    }
+
+    if (_create_file() < 0) {
+        fprintf(stderr, "error creating " TEST_FILE "\n");
+        return 1;
+    }
+
+    memset(&dev, 0, sizeof(dev));
+    dev.pf_file_open_bdrom = _open_bdrom;
+
+    dec = dec_init(&dev, &enc_info, NULL, NULL, NULL, NULL);
+    if (!dec) {
+        fprintf(stderr, "dec_init() failed\n");
+        goto out;
+    }
+
+    /* title events: AACS CPS unit must be selected in all handles */
+    dec_start(dec, 0);
+    dec_title(dec, TITLE);
+
+    /* reference: decrypt in reading thread */
+    if (dec_set_threads(dec, 1) != 1 || _check(dec, 5) < 0) {
+        goto out;
+    }
+
+    threads = dec_set_threads(dec, 4);
+    if (threads != 4) {
+        fprintf(stderr, "dec_set_threads(4) returned %u\n", threads);
+        goto out;
+    }
+    if (_check(dec, 5) < 0 || _check(dec, 9) < 0) {
+        goto out;
+    }
+
+    /* title change after workers have been started */
+    dec_title(dec, TITLE + 1);
+    dec_title(dec, TITLE);
+    if (_check(dec, 11) < 0) {
+        goto out;
+    }
+
+    result = 0;
+
+ out:
+    dec_close(&dec);
+    (void)file_unlink(TEST_FILE);
+    return result;
+}
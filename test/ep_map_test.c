@@ -0,0 +1,327 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * EP map searches (clpi_lookup_spn(), clpi_access_point()) must return
+ * the same results as linear scan of the EP map.
+ * Clips are created with clpi_copy(), which builds the search index for
+ * sorted EP maps. Unsorted EP maps test linear fallback.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "bdnav/clpi_data.h"
+#include "bdnav/clpi_parse.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t _rand(uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+/*
+ * reference implementation (linear scan)
+ */
+
+static uint32_t _coarse_pts(const CLPI_EP_MAP_ENTRY *entry, int ii)
+{
+    return (uint32_t)(entry->coarse[ii].pts_ep & ~0x01) << 18;
+}
+
+static uint32_t _coarse_spn(const CLPI_EP_MAP_ENTRY *entry, int ii)
+{
+    return entry->coarse[ii].spn_ep & ~0x1FFFF;
+}
+
+static int _coarse_end(const CLPI_EP_MAP_ENTRY *entry, int ii)
+{
+    return ii < entry->num_ep_coarse - 1 ? entry->coarse[ii+1].ref_ep_fine_id : entry->num_ep_fine;
+}
+
+static uint32_t _ref_lookup_spn(const CLPI_CL *cl, uint32_t timestamp, int before, uint8_t stc_id)
+{
+    const CLPI_EP_MAP_ENTRY *entry = &cl->cpi.entry[0];
+    uint32_t stc_spn, pts;
+    int      ii, jj, start, end, ref;
+
+    stc_spn = clpi_find_stc_spn(cl, stc_id);
+    for (ii = 0; ii < entry->num_ep_coarse; ii++) {
+        if (entry->coarse[ii].spn_ep >= stc_spn) {
+            break;
+        }
+    }
+    if (ii >= entry->num_ep_coarse) {
+        return cl->clip.num_source_packets;
+    }
+    ref = entry->coarse[ii].ref_ep_fine_id;
+    pts = _coarse_pts(entry, ii) + ((uint32_t)entry->fine[ref].pts_ep << 8);
+    if (pts > timestamp && ii) {
+        ii--;
+        start = entry->coarse[ii].ref_ep_fine_id;
+        end   = entry->coarse[ii+1].ref_ep_fine_id;
+        for (jj = start; jj < end; jj++) {
+            pts = _coarse_pts(entry, ii) + ((uint32_t)entry->fine[jj].pts_ep << 8);
+            if (stc_spn >= _coarse_spn(entry, ii) + (uint32_t)entry->fine[jj].spn_ep && pts > timestamp) {
+                break;
+            }
+        }
+    } else {
+        for (; ii < entry->num_ep_coarse; ii++) {
+            ref = entry->coarse[ii].ref_ep_fine_id;
+            if (_coarse_pts(entry, ii) + ((uint32_t)entry->fine[ref].pts_ep << 8) > timestamp) {
+                break;
+            }
+        }
+        if (ii == 0) {
+            return 0;
+        }
+        ii--;
+        start = entry->coarse[ii].ref_ep_fine_id;
+        end   = _coarse_end(entry, ii);
+        for (jj = start; jj < end; jj++) {
+            if (_coarse_pts(entry, ii) + ((uint32_t)entry->fine[jj].pts_ep << 8) > timestamp) {
+                break;
+            }
+        }
+    }
+
+    if (before) {
+        jj--;
+    }
+    if (jj == end) {
+        ii++;
+        if (ii >= entry->num_ep_coarse) {
+            return cl->clip.num_source_packets;
+        }
+        jj = entry->coarse[ii].ref_ep_fine_id;
+    }
+    return _coarse_spn(entry, ii) + (uint32_t)entry->fine[jj].spn_ep;
+}
+
+static uint32_t _ref_access_point(const CLPI_CL *cl, uint32_t pkt, int next, int angle_change, uint32_t *time)
+{
+    const CLPI_EP_MAP_ENTRY *entry = &cl->cpi.entry[0];
+    uint32_t spn = 0;
+    int      ii, jj, start, end, ref;
+
+    for (ii = 0; ii < entry->num_ep_coarse; ii++) {
+        ref = entry->coarse[ii].ref_ep_fine_id;
+        if (_coarse_spn(entry, ii) + (uint32_t)entry->fine[ref].spn_ep > pkt) {
+            break;
+        }
+    }
+    if (ii == 0) {
+        *time = 0;
+        return 0;
+    }
+    ii--;
+    start = entry->coarse[ii].ref_ep_fine_id;
+    end   = _coarse_end(entry, ii);
+    for (jj = start; jj < end; jj++) {
+        spn = _coarse_spn(entry, ii) + (uint32_t)entry->fine[jj].spn_ep;
+        if (spn >= pkt) {
+            break;
+        }
+    }
+    if (jj == end && next) {
+        /* first entry point of next coarse entry */
+        ii++;
+        if (ii < entry->num_ep_coarse) {
+            jj  = entry->coarse[ii].ref_ep_fine_id;
+            end = _coarse_end(entry, ii);
+        }
+    } else if (spn != pkt && !next) {
+        jj--;
+    }
+    if (ii == entry->num_ep_coarse) {
+        *time = 0;
+        return cl->clip.num_source_packets;
+    }
+    if (angle_change) {
+        /* first angle change point at or after jj */
+        for (;;) {
+            for (; jj < end; jj++) {
+                if (entry->fine[jj].is_angle_change_point) {
+                    *time = _coarse_pts(entry, ii) + ((uint32_t)entry->fine[jj].pts_ep << 8);
+                    return _coarse_spn(entry, ii) + (uint32_t)entry->fine[jj].spn_ep;
+                }
+            }
+            if (++ii >= entry->num_ep_coarse) {
+                break;
+            }
+            jj  = entry->coarse[ii].ref_ep_fine_id;
+            end = _coarse_end(entry, ii);
+        }
+        *time = 0;
+        return cl->clip.num_source_packets;
+    }
+    *time = _coarse_pts(entry, ii) + ((uint32_t)entry->fine[jj].pts_ep << 8);
+    return _coarse_spn(entry, ii) + (uint32_t)entry->fine[jj].spn_ep;
+}
+
+/*
+ * test
+ */
+
+/* create random EP map. Coarse entries are created when coarse PTS or SPN changes. */
+static int _create_ep_map(CLPI_EP_MAP_ENTRY *e, uint32_t *seed, int sorted)
+{
+    uint64_t pts = _rand(seed) % 100000;
+    uint64_t spn = _rand(seed) % 1000;
+    int      nf  = 1 + (int)(_rand(seed) % 400);
+    int      jj;
+
+    e->fine   = calloc(nf, sizeof(CLPI_EP_FINE));
+    e->coarse = calloc(nf, sizeof(CLPI_EP_COARSE));
+    if (!e->fine || !e->coarse) {
+        return -1;
+    }
+
+    e->num_ep_fine   = nf;
+    e->num_ep_coarse = 0;
+    for (jj = 0; jj < nf; jj++) {
+        int cpts, cspn;
+
+        pts += 1000 + _rand(seed) % 40000;
+        spn += 100 + _rand(seed) % 30000;
+        cpts = (int)((pts >> 19) & 0x3fff) << 1;
+        cspn = (int)(spn & ~0x1ffff);
+
+        if (jj == 0 || cpts != e->coarse[e->num_ep_coarse - 1].pts_ep ||
+            (uint32_t)cspn != (e->coarse[e->num_ep_coarse - 1].spn_ep & ~0x1ffff)) {
+            e->coarse[e->num_ep_coarse].ref_ep_fine_id = jj;
+            e->coarse[e->num_ep_coarse].pts_ep         = cpts;
+            e->coarse[e->num_ep_coarse].spn_ep         = (uint32_t)spn;
+            e->num_ep_coarse++;
+        }
+        e->fine[jj].pts_ep = (int)((pts >> 9) & 0x7ff);
+        e->fine[jj].spn_ep = (int)(spn & 0x1ffff);
+        e->fine[jj].is_angle_change_point = (_rand(seed) % 5) == 0;
+    }
+
+    if (!sorted && nf > 2) {
+        /* swap two fine entries */
+        CLPI_EP_FINE tmp = e->fine[1];
+        e->fine[1] = e->fine[2];
+        e->fine[2] = tmp;
+    }
+
+    return 0;
+}
+
+static int _test_clip(const CLPI_CL *cl, uint32_t *seed)
+{
+    const CLPI_EP_MAP_ENTRY *entry = &cl->cpi.entry[0];
+    uint32_t max_pts = _coarse_pts(entry, entry->num_ep_coarse - 1) + 0x80000;
+    uint32_t max_spn = cl->clip.num_source_packets + 1000;
+    int      ii;
+
+    for (ii = 0; ii < 300; ii++) {
+        uint32_t ts  = _rand(seed) % (max_pts + 100000);
+        uint32_t pkt = _rand(seed) % max_spn;
+        int      before, next, angle;
+
+        /* exact entry point */
+        if (ii % 4 == 0) {
+            pkt = clpi_lookup_spn(cl, ts, 1, 0);
+        }
+
+        for (before = 0; before < 2; before++) {
+            if (clpi_lookup_spn(cl, ts, before, 0) != _ref_lookup_spn(cl, ts, before, 0)) {
+                fprintf(stderr, "clpi_lookup_spn(%u, %d) mismatch\n", ts, before);
+                return -1;
+            }
+        }
+
+        for (next = 0; next < 2; next++) {
+            for (angle = 0; angle < 2; angle++) {
+                uint32_t time, ref_time;
+                uint32_t spn     = clpi_access_point(cl, pkt, next, angle, &time);
+                uint32_t ref_spn = _ref_access_point(cl, pkt, next, angle, &ref_time);
+                if (spn != ref_spn || time != ref_time) {
+                    fprintf(stderr, "clpi_access_point(%u, %d, %d): got %u/%u, expected %u/%u\n",
+                            pkt, next, angle, spn, time, ref_spn, ref_time);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    uint32_t seed = 1;
+    int      ii;
+
+    for (ii = 0; ii < 2000; ii++) {
+        CLPI_STC_SEQ      stc;
+        CLPI_ATC_SEQ      atc;
+        CLPI_EP_MAP_ENTRY entry;
+        CLPI_CL           src, *cl;
+        int               r;
+
+        memset(&stc, 0, sizeof(stc));
+        memset(&atc, 0, sizeof(atc));
+        memset(&entry, 0, sizeof(entry));
+        memset(&src, 0, sizeof(src));
+
+        if (_create_ep_map(&entry, &seed, ii % 10 != 0) < 0) {
+            free(entry.fine);
+            free(entry.coarse);
+            return 1;
+        }
+
+        stc.spn_stc_start = (ii & 1) ? 0 : _rand(&seed) % (entry.coarse[entry.num_ep_coarse - 1].spn_ep + 1);
+        atc.num_stc_seq   = 1;
+        atc.stc_seq       = &stc;
+
+        src.sequence.num_atc_seq = 1;
+        src.sequence.atc_seq     = &atc;
+        src.cpi.num_stream_pid   = 1;
+        src.cpi.entry            = &entry;
+        src.clip.num_source_packets = entry.coarse[entry.num_ep_coarse - 1].spn_ep + 500000;
+
+        /* builds search index */
+        cl = clpi_copy(&src);
+        free(entry.fine);
+        free(entry.coarse);
+        if (!cl) {
+            fprintf(stderr, "clpi_copy() failed\n");
+            return 1;
+        }
+
+        r = _test_clip(cl, &seed);
+        clpi_free(&cl);
+        if (r < 0) {
+            fprintf(stderr, "clip %d failed\n", ii);
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Minimal libaacs replacement for tests (loaded with LIBAACS_PATH).
+ *
+ * "Decryption" XORs unit payload with a key derived from selected title
+ * and unit seed, and clears copy permission indicator bits.
+ * Decryption fails if the same handle is used from two threads at once.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* libaacs API (subset used by libbluray) */
+void          *aacs_init(void);
+int            aacs_open_device(void *, const char *, const char *);
+void           aacs_close(void *);
+void           aacs_select_title(void *, uint32_t);
+int            aacs_get_mkb_version(void *);
+const uint8_t *aacs_get_disc_id(void *);
+int            aacs_decrypt_unit(void *, uint8_t *);
+
+typedef struct {
+    pthread_mutex_t mutex;  /* detects concurrent use */
+    uint32_t        title;
+} FAKE_AACS;
+
+static const uint8_t disc_id[20] = { 0x10, 0x20, 0x30, 0x40 };
+
+void *aacs_init(void)
+{
+    FAKE_AACS *aacs = calloc(1, sizeof(*aacs));
+    if (aacs) {
+        pthread_mutex_init(&aacs->mutex, NULL);
+        aacs->title = 0xffff;
+    }
+    return aacs;
+}
+
+int aacs_open_device(void *p, const char *path, const char *keyfile_path)
+{
+    (void)p;
+    (void)path;
+    (void)keyfile_path;
+    return 0;
+}
+
+void aacs_close(void *p)
+{
+    FAKE_AACS *aacs = p;
+    if (aacs) {
+        pthread_mutex_destroy(&aacs->mutex);
+        free(aacs);
+    }
+}
+
+void aacs_select_title(void *p, uint32_t title)
+{
+    FAKE_AACS *aacs = p;
+    if (pthread_mutex_trylock(&aacs->mutex)) {
+        abort();
+    }
+    aacs->title = title;
+    pthread_mutex_unlock(&aacs->mutex);
+}
+
+int aacs_get_mkb_version(void *p)
+{
+    (void)p;
+    return 68;
+}
+
+const uint8_t *aacs_get_disc_id(void *p)
+{
+    (void)p;
+    return disc_id;
+}
+
+/* same as in dec_test.c */
+static void _crypt_unit(uint8_t *buf, uint32_t title)
+{
+    unsigned ii;
+
+    for (ii = 16; ii < 6144; ii++) {
+        buf[ii] ^= (uint8_t)(buf[ii % 16] + ii + title);
+    }
+}
+
+int aacs_decrypt_unit(void *p, uint8_t *buf)
+{
+    FAKE_AACS *aacs = p;
+    unsigned   ii;
+
+    if (pthread_mutex_trylock(&aacs->mutex)) {
+        return 0;
+    }
+
+    if (buf[0] & 0xc0) {
+        _crypt_unit(buf, aacs->title);
+        for (ii = 0; ii < 6144; ii += 192) {
+            buf[ii] &= ~0xc0;
+        }
+    }
+
+    pthread_mutex_unlock(&aacs->mutex);
+    return 1;
+}
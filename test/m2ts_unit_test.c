@@ -0,0 +1,117 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Aligned unit summary (m2ts_unit_scan()) must match parsing each
+ * packet header byte by byte.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "decoders/m2ts_unit.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static uint32_t _rand(uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+static int _check(const uint8_t *unit, const M2TS_UNIT_INFO *info)
+{
+    unsigned ii, broken = 0;
+
+    for (ii = 0; ii < 32; ii++) {
+        const uint8_t *p   = unit + ii * 192;
+        uint16_t       pid = (uint16_t)(((p[5] & 0x1f) << 8) | p[6]);
+
+        if (!!(info->sync_ok & (1u << ii)) != (p[4] == 0x47) ||
+            !!(info->pusi & (1u << ii))    != !!(p[5] & 0x40) ||
+            !!(info->cpi & (1u << ii))     != !!(p[0] & 0xc0) ||
+            info->pid[ii] != pid) {
+            fprintf(stderr, "packet %u: header mismatch\n", ii);
+            return -1;
+        }
+        if (!m2ts_unit_has_pid(info, pid)) {
+            fprintf(stderr, "packet %u: pid 0x%04x not found\n", ii, pid);
+            return -1;
+        }
+        broken += (p[4] != 0x47);
+    }
+
+    if (m2ts_unit_num_broken(info) != broken) {
+        fprintf(stderr, "broken packet count mismatch\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    uint8_t  unit[6144];
+    uint32_t seed = 1;
+    unsigned ii, jj;
+
+    for (ii = 0; ii < 100000; ii++) {
+        M2TS_UNIT_INFO info;
+        uint16_t       pid;
+
+        for (jj = 0; jj < sizeof(unit); jj++) {
+            unit[jj] = (uint8_t)_rand(&seed);
+        }
+        /* mostly valid packets, few pids */
+        for (jj = 0; jj < 32; jj++) {
+            if (_rand(&seed) % 8) {
+                unit[jj * 192 + 4] = 0x47;
+            }
+            if (_rand(&seed) % 2) {
+                unit[jj * 192 + 5] &= 0xe0;
+                unit[jj * 192 + 6]  = (uint8_t)(_rand(&seed) % 4);
+            }
+        }
+
+        memset(&info, 0xaa, sizeof(info));
+        m2ts_unit_scan(unit, &info);
+
+        if (_check(unit, &info) < 0) {
+            fprintf(stderr, "unit %u failed\n", ii);
+            return 1;
+        }
+
+        /* random pid */
+        pid = (uint16_t)(_rand(&seed) & 0x1fff);
+        for (jj = 0; jj < 32; jj++) {
+            if (info.pid[jj] == pid) {
+                break;
+            }
+        }
+        if ((jj < 32) != !!m2ts_unit_has_pid(&info, pid)) {
+            fprintf(stderr, "m2ts_unit_has_pid(0x%04x) mismatch\n", pid);
+            return 1;
+        }
+    }
+
+    return 0;
+}
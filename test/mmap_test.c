@@ -0,0 +1,150 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Memory-mapped file (file_open_mmap()) must behave like default file
+ * implementation: same data, return values and file position for random
+ * seeks (also past end of file) and read sizes.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "file/file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_FILE  "mmap_test.tmp"
+#define FILE_SIZE  (1000 * 6144 + 1234)
+#define MAX_READ   (256 * 1024)
+
+static uint32_t _rand(uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+static int _create_file(void)
+{
+    static uint8_t buf[FILE_SIZE];
+    uint32_t seed = 1;
+    unsigned ii;
+    FILE    *f = fopen(TEST_FILE, "wb");
+
+    if (!f) {
+        return -1;
+    }
+    for (ii = 0; ii < FILE_SIZE; ii++) {
+        buf[ii] = (uint8_t)_rand(&seed);
+    }
+    if (fwrite(buf, 1, FILE_SIZE, f) != FILE_SIZE) {
+        fclose(f);
+        return -1;
+    }
+    return fclose(f) ? -1 : 0;
+}
+
+static int _test(BD_FILE_H *ref, BD_FILE_H *fp)
+{
+    static uint8_t buf_ref[MAX_READ], buf[MAX_READ];
+    static const int32_t origins[] = { SEEK_SET, SEEK_CUR, SEEK_END };
+    uint32_t seed = 7;
+    int      ii;
+
+    if (file_size(fp) != file_size(ref)) {
+        fprintf(stderr, "file size mismatch\n");
+        return -1;
+    }
+
+    for (ii = 0; ii < 5000; ii++) {
+        int64_t size, got_ref, got;
+
+        if (_rand(&seed) % 4 == 0) {
+            int32_t origin = origins[_rand(&seed) % 3];
+            int64_t offset = (int64_t)(_rand(&seed) % (3 * FILE_SIZE)) - FILE_SIZE;
+            int64_t pos_ref, pos;
+
+            pos_ref = ref->seek(ref, offset, origin);
+            pos     = fp->seek(fp, offset, origin);
+            if (pos != pos_ref) {
+                fprintf(stderr, "seek(%lld, %d): got %lld, expected %lld\n",
+                        (long long)offset, origin, (long long)pos, (long long)pos_ref);
+                return -1;
+            }
+        }
+
+        size    = 1 + _rand(&seed) % MAX_READ;
+        got_ref = ref->read(ref, buf_ref, size);
+        got     = fp->read(fp, buf, size);
+        if (got != got_ref) {
+            fprintf(stderr, "read(%lld): got %lld, expected %lld\n",
+                    (long long)size, (long long)got, (long long)got_ref);
+            return -1;
+        }
+        if (got > 0 && memcmp(buf, buf_ref, (size_t)got)) {
+            fprintf(stderr, "data mismatch\n");
+            return -1;
+        }
+        if (file_tell(fp) != file_tell(ref)) {
+            fprintf(stderr, "position mismatch\n");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    BD_FILE_H *ref = NULL, *fp = NULL;
+    int        result = 1;
+
+    if (_create_file() < 0) {
+        fprintf(stderr, "error creating " TEST_FILE "\n");
+        return 1;
+    }
+
+    fp = file_open_mmap(TEST_FILE);
+    if (!fp) {
+        fprintf(stderr, "memory-mapped I/O not supported\n");
+        result = 77;
+        goto out;
+    }
+    ref = file_open_default()(TEST_FILE, "rb");
+    if (!ref) {
+        fprintf(stderr, "error opening " TEST_FILE "\n");
+        goto out;
+    }
+
+    if (_test(ref, fp) < 0) {
+        goto out;
+    }
+
+    result = 0;
+
+ out:
+    if (fp) file_close(fp);
+    if (ref) file_close(ref);
+    (void)file_unlink(TEST_FILE);
+    return result;
+}
@@ -0,0 +1,358 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+
+/*
+ * Demuxing PES packets into buffers from PES_BUFFER_POOL must produce the
+ * same packets as demuxing into freshly allocated buffers.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "decoders/m2ts_demux.h"
+#include "decoders/pes_buffer.h"
+#include "util/log_control.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PID       0x1200
+#define MAX_PES   0x10000
+#define MAX_HELD  64
+#define NUM_UNITS 20000
+
+static uint32_t _rand(uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+/*
+ * stream generator
+ */
+
+typedef struct {
+    uint32_t seed;
+    uint8_t  pes[MAX_PES + 32];
+    unsigned pes_len;
+    unsigned pes_pos;
+} GEN;
+
+static void _timestamp(uint8_t *p, unsigned marker, int64_t ts)
+{
+    p[0] = marker << 4 | (ts >> 29 & 0x0e) | 1;
+    p[1] = ts >> 22;
+    p[2] = (ts >> 14 & 0xfe) | 1;
+    p[3] = ts >> 7;
+    p[4] = (ts << 1 & 0xfe) | 1;
+}
+
+static void _new_pes(GEN *g)
+{
+    unsigned r       = _rand(&g->seed) % 16;
+    unsigned payload = r < 8 ? _rand(&g->seed) % 200 : r < 14 ? _rand(&g->seed) % 4000 : _rand(&g->seed) % (MAX_PES - 20);
+    unsigned hdr     = 6;
+    unsigned i;
+
+    g->pes[0] = 0;
+    g->pes[1] = 0;
+    g->pes[2] = 1;
+
+    if (_rand(&g->seed) % 8 == 0) {
+        g->pes[3] = 0xbf;
+    } else {
+        unsigned flags = _rand(&g->seed) % 3;  /* none, PTS, PTS+DTS */
+        g->pes[3] = 0xbd;
+        g->pes[6] = 0x81;
+        g->pes[7] = flags == 0 ? 0 : flags == 1 ? 0x80 : 0xc0;
+        g->pes[8] = flags * 5;
+        if (flags) {
+            _timestamp(g->pes + 9, flags == 1 ? 2 : 3, ((int64_t)_rand(&g->seed) << 9) ^ _rand(&g->seed));
+        }
+        if (flags == 2) {
+            _timestamp(g->pes + 14, 1, ((int64_t)_rand(&g->seed) << 9) ^ _rand(&g->seed));
+        }
+        hdr = 9 + g->pes[8];
+    }
+
+    g->pes[4] = (payload + hdr - 6) >> 8;
+    g->pes[5] = (payload + hdr - 6);
+    for (i = 0; i < payload; i++) {
+        g->pes[hdr + i] = _rand(&g->seed);
+    }
+
+    /* corrupted start code */
+    if (_rand(&g->seed) % 64 == 0) {
+        g->pes[_rand(&g->seed) % 3] ^= 0x10;
+    }
+
+    g->pes_len = hdr + payload;
+    g->pes_pos = 0;
+}
+
+static void _packet(GEN *g, uint8_t *tp)
+{
+    unsigned space, n;
+
+    memset(tp, 0xff, 192);
+    memset(tp, 0, 4);
+    tp[4] = 0x47;
+
+    /* other pid */
+    if (_rand(&g->seed) % 4 == 0) {
+        tp[5] = 0x10;
+        tp[6] = 0x11;
+        tp[7] = 0x10;
+        return;
+    }
+
+    if (g->pes_pos >= g->pes_len) {
+        _new_pes(g);
+    }
+
+    tp[5] = (g->pes_pos == 0 ? 0x40 : 0) | PID >> 8;
+    tp[6] = PID & 0xff;
+    tp[7] = 0x10;
+
+    /* adaptation field */
+    space = 184;
+    if (_rand(&g->seed) % 8 == 0) {
+        tp[7] |= 0x20;
+        tp[8]  = _rand(&g->seed) % 20;
+        space -= tp[8] + 1;
+    }
+
+    n = g->pes_len - g->pes_pos;
+    if (n < space) {
+        /* stuffing */
+        tp[7] |= 0x20;
+        tp[8]  = 183 - n;
+        space  = n;
+    }
+    memcpy(tp + 192 - space, g->pes + g->pes_pos, space);
+    g->pes_pos += space;
+
+    /* errors */
+    switch (_rand(&g->seed) % 128) {
+        case 0: tp[5] |= 0x80; break;   /* transport error */
+        case 1: tp[7] &= ~0x10; break;  /* no payload */
+        case 2: tp[5] = 0; tp[6] = 0; break;  /* lost packet */
+    }
+}
+
+/*
+ * output
+ */
+
+typedef struct {
+    uint8_t  *data;
+    uint32_t  len;
+    int64_t   pts;
+    int64_t   dts;
+} PKT;
+
+static int _check(const PES_BUFFER *b, const PES_BUFFER *ref)
+{
+    if (b->len != ref->len || b->pts != ref->pts || b->dts != ref->dts) {
+        fprintf(stderr, "PES mismatch: len %u/%u pts %lld/%lld dts %lld/%lld\n",
+                (unsigned)b->len, (unsigned)ref->len,
+                (long long)b->pts, (long long)ref->pts,
+                (long long)b->dts, (long long)ref->dts);
+        return -1;
+    }
+    if (b->size < b->len || (b->len && memcmp(b->buf, ref->buf, b->len))) {
+        fprintf(stderr, "PES payload mismatch (%u bytes)\n", (unsigned)b->len);
+        return -1;
+    }
+    return 0;
+}
+
+static int _check_held(const PES_BUFFER *b, const PKT *k)
+{
+    if (b->len != k->len || b->pts != k->pts || b->dts != k->dts ||
+        (k->len && memcmp(b->buf, k->data, k->len))) {
+        fprintf(stderr, "held PES buffer modified\n");
+        return -1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    GEN              gen;
+    PES_BUFFER_POOL *pool  = pes_buffer_pool_init();
+    M2TS_DEMUX      *dpool = m2ts_demux_init(PID, pool);
+    M2TS_DEMUX      *dref  = m2ts_demux_init(PID, NULL);
+    PES_BUFFER      *held[MAX_HELD];
+    PKT              held_ref[MAX_HELD];
+    unsigned         num_held = 0;
+    unsigned         num_pes = 0;
+    uint32_t         seed = 1;
+    uint8_t          unit[6144];
+    unsigned         u, i;
+    int              result = 1;
+
+    if (!pool || !dpool || !dref) {
+        fprintf(stderr, "init failed\n");
+        return 1;
+    }
+
+    bd_set_debug_mask(0);
+
+    memset(&gen, 0, sizeof(gen));
+    gen.seed = 12345;
+
+    for (u = 0; u < NUM_UNITS; u++) {
+        PES_BUFFER *out, *ref, *b, *r;
+        int flush = (_rand(&seed) % 256 == 0);
+
+        for (i = 0; i < 32; i++) {
+            _packet(&gen, unit + i * 192);
+        }
+
+        if (_rand(&seed) % 512 == 0) {
+            m2ts_demux_reset(dpool);
+            m2ts_demux_reset(dref);
+        }
+
+        out = m2ts_demux(dpool, flush ? NULL : unit);
+        ref = m2ts_demux(dref,  flush ? NULL : unit);
+
+        for (b = out, r = ref; b && r; b = b->next, r = r->next) {
+            if (_check(b, r) < 0 || b->pool != pool || r->pool) {
+                break;
+            }
+            num_pes++;
+        }
+        pes_buffer_free(&ref);
+        if (b || r) {
+            fprintf(stderr, "unit %u: PES mismatch\n", u);
+            pes_buffer_free(&out);
+            goto out;
+        }
+
+        /* release pooled buffers in different ways, keep some of them */
+        while (out) {
+            switch (_rand(&seed) % 4) {
+                case 0:
+                    /* remove random buffer from list */
+                    for (b = out, i = _rand(&seed) % 4; b->next && i; b = b->next, i--) ;
+                    pes_buffer_remove(&out, b);
+                    break;
+                case 1:
+                    b = out;
+                    out = b->next;
+                    b->next = NULL;
+                    if (num_held < MAX_HELD) {
+                        PKT *k = &held_ref[num_held];
+                        k->data = malloc(b->len + 1);
+                        if (!k->data) {
+                            pes_buffer_free(&b);
+                            pes_buffer_free(&out);
+                            goto out;
+                        }
+                        memcpy(k->data, b->buf, b->len);
+                        k->len = b->len;
+                        k->pts = b->pts;
+                        k->dts = b->dts;
+                        held[num_held++] = b;
+                    } else {
+                        pes_buffer_free(&b);
+                    }
+                    break;
+                case 2:
+                    pes_buffer_next(&out);
+                    break;
+                default:
+                    pes_buffer_free(&out);
+                    break;
+            }
+        }
+
+        /* held buffers must not be re-used */
+        for (i = 0; i < num_held; i++) {
+            if (_check_held(held[i], &held_ref[i]) < 0) {
+                fprintf(stderr, "unit %u\n", u);
+                goto out;
+            }
+        }
+        if (num_held && _rand(&seed) % 3 == 0) {
+            i = _rand(&seed) % num_held;
+            pes_buffer_free(&held[i]);
+            free(held_ref[i].data);
+            num_held--;
+            held[i]     = held[num_held];
+            held_ref[i] = held_ref[num_held];
+        }
+
+        /* pes_buffer_append() with tail must build the same list */
+        if (_rand(&seed) % 64 == 0) {
+            PES_BUFFER *l1 = NULL, *l2 = NULL, *tail = NULL;
+            unsigned n = 1 + _rand(&seed) % 8;
+            unsigned n1 = 0, n2 = 0;
+            for (i = 0; i < n; i++) {
+                PES_BUFFER *a1 = pes_buffer_alloc(pool);
+                PES_BUFFER *a2 = pes_buffer_alloc(NULL);
+                /* append single buffer or list */
+                if (a1 && a2 && i & 1) {
+                    a1->next = pes_buffer_alloc(pool);
+                    a2->next = pes_buffer_alloc(NULL);
+                }
+                pes_buffer_append(&l1, &tail, a1);
+                pes_buffer_append(&l2, NULL, a2);
+            }
+            n += n / 2;
+            for (b = l1; b; b = b->next, n1++) {
+                if (!b->next && b != tail) {
+                    fprintf(stderr, "append: wrong tail\n");
+                    n1 = 0;
+                    break;
+                }
+            }
+            for (r = l2; r; r = r->next, n2++) ;
+            pes_buffer_free(&l1);
+            pes_buffer_free(&l2);
+            if (n1 != n || n2 != n) {
+                fprintf(stderr, "append: list length mismatch\n");
+                goto out;
+            }
+        }
+    }
+
+    if (num_pes < NUM_UNITS / 2) {
+        fprintf(stderr, "too few PES packets (%u)\n", num_pes);
+        goto out;
+    }
+
+    result = 0;
+
+ out:
+    for (i = 0; i < num_held; i++) {
+        pes_buffer_free(&held[i]);
+        free(held_ref[i].data);
+    }
+    m2ts_demux_free(&dpool);
+    m2ts_demux_free(&dref);
+    pes_buffer_pool_free(&pool);
+    return result;
+}
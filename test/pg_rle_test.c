@@ -0,0 +1,248 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Table-driven PG object RLE decoding (pg_decode_rle()) must produce the
+ * same elements as reading RLE codes bit by bit.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "decoders/pg_decode.h"
+#include "util/bits.h"
+#include "util/log_control.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_W     20000
+#define MAX_H     30
+#define MAX_DATA  (MAX_W * MAX_H * 4 + MAX_H * 2)
+#define MAX_ELEM  (MAX_DATA + 2 * MAX_H)
+
+static uint32_t _rand(uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+/* encode random image. Returns size of data. */
+static size_t _encode(uint32_t *seed, uint8_t *o, unsigned w, unsigned h)
+{
+    size_t   n = 0;
+    unsigned x, y;
+
+    for (y = 0; y < h; y++) {
+        for (x = 0; x < w; ) {
+            unsigned r     = _rand(seed) % 16;
+            unsigned len   = 1 + _rand(seed) % (r < 10 ? 4 : r < 15 ? 300 : 16383);
+            unsigned color = _rand(seed) % 3 ? _rand(seed) & 0xff : 0;
+            int      lng   = _rand(seed) % 8 == 0;  /* long code for short run */
+
+            len = len < w - x ? len : w - x;
+            if (len == 1 && color && !lng) {
+                o[n++] = (uint8_t)color;
+            } else if (len < 64 && !lng) {
+                o[n++] = 0;
+                o[n++] = (uint8_t)((color ? 0x80 : 0x00) | len);
+                if (color) {
+                    o[n++] = (uint8_t)color;
+                }
+            } else {
+                o[n++] = 0;
+                o[n++] = (uint8_t)((color ? 0xc0 : 0x40) | (len >> 8));
+                o[n++] = (uint8_t)len;
+                if (color) {
+                    o[n++] = (uint8_t)color;
+                }
+            }
+            x += len;
+        }
+        /* end of line */
+        o[n++] = 0;
+        o[n++] = 0;
+    }
+
+    return n;
+}
+
+/* reference: read codes bit by bit. Returns number of elements, -1 if too many pixels, -2 if missing pixels. */
+static int _ref_decode(const uint8_t *data, size_t size, unsigned w, unsigned h, BD_PG_RLE_ELEM *img)
+{
+    BITBUFFER bb;
+    int64_t   pixels_left = (int64_t)w * h;
+    int       num_rle = 0;
+
+    bb_init(&bb, data, size);
+
+    while (!bb_eof(&bb)) {
+        uint32_t len   = 1;
+        uint8_t  color = 0;
+
+        if (!(color = (uint8_t)bb_read(&bb, 8))) {
+            int has_color = bb_read(&bb, 1);
+            len = bb_read(&bb, 1) ? bb_read(&bb, 14) : bb_read(&bb, 6);
+            if (has_color) {
+                color = (uint8_t)bb_read(&bb, 8);
+            }
+        }
+
+        img[num_rle].len   = (uint16_t)len;
+        img[num_rle].color = color;
+        num_rle++;
+
+        pixels_left -= len;
+        if (pixels_left < 0) {
+            return -1;
+        }
+    }
+
+    return pixels_left > 0 ? -2 : num_rle;
+}
+
+static int _compare(const BD_PG_RLE_ELEM *a, const BD_PG_RLE_ELEM *b, int count)
+{
+    int ii;
+
+    for (ii = 0; ii < count; ii++) {
+        if (a[ii].len != b[ii].len || a[ii].color != b[ii].color) {
+            fprintf(stderr, "element %d: got %u/%u, expected %u/%u\n",
+                    ii, a[ii].len, a[ii].color, b[ii].len, b[ii].color);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int _test(uint32_t *seed, uint8_t *data, BD_PG_RLE_ELEM *ref, BD_PG_RLE_ELEM *img)
+{
+    unsigned w = 1 + _rand(seed) % (_rand(seed) % 8 ? 300 : MAX_W);
+    unsigned h = 1 + _rand(seed) % MAX_H;
+    size_t   size = _encode(seed, data, w, h);
+    unsigned missing_eol, missing_lines, ii;
+    int      num_ref, num;
+
+    /* valid image */
+    num_ref = _ref_decode(data, size, w, h, ref);
+    num     = pg_decode_rle(data, size, img, MAX_ELEM, w, h);
+    if (num_ref < 0 || num != num_ref || _compare(img, ref, num) < 0) {
+        fprintf(stderr, "valid image: got %d elements, expected %d\n", num, num_ref);
+        return -1;
+    }
+
+    /* output buffer size */
+    if (pg_decode_rle(data, size, img, (size_t)num, w, h) != num ||
+        pg_decode_rle(data, size, img, (size_t)num - 1, w, h) != -1) {
+        fprintf(stderr, "output buffer size not checked\n");
+        return -1;
+    }
+
+    /* missing end of line markers at the end: padded */
+    missing_eol = 1 + _rand(seed) % 2;
+    for (ii = 0; ii < missing_eol && size >= 2 && data[size - 2] == 0 && data[size - 1] == 0; ii++) {
+        size -= 2;
+    }
+    num_ref = _ref_decode(data, size, w, h, ref);
+    num     = pg_decode_rle(data, size, img, MAX_ELEM, w, h);
+    if (num_ref >= 0) {
+        if (num < num_ref || _compare(img, ref, num_ref) < 0) {
+            fprintf(stderr, "missing end of line: got %d elements, expected %d + padding\n", num, num_ref);
+            return -1;
+        }
+        for (; num_ref < num; num_ref++) {
+            if (img[num_ref].len != 0) {
+                fprintf(stderr, "missing end of line: invalid padding\n");
+                return -1;
+            }
+        }
+    }
+
+    /* missing lines: padded with transparent pixels */
+    missing_lines = 1 + _rand(seed) % h;
+    size    = _encode(seed, data, w, h - missing_lines);
+    num_ref = _ref_decode(data, size, w, h - missing_lines, ref);
+    num     = pg_decode_rle(data, size, img, MAX_ELEM, w, h);
+    if (num_ref < 0 || num != num_ref + 2 * (int)missing_lines || _compare(img, ref, num_ref) < 0) {
+        fprintf(stderr, "missing lines: got %d elements, expected %d + padding\n", num, num_ref);
+        return -1;
+    }
+    for (ii = 0; ii < missing_lines; ii++) {
+        const BD_PG_RLE_ELEM *pad = img + num_ref + 2 * ii;
+        if (pad[0].len != w || pad[0].color != 0xff || pad[1].len != 0) {
+            fprintf(stderr, "missing lines: invalid padding\n");
+            return -1;
+        }
+    }
+
+    /* corrupted data: results must match when both succeed */
+    size = _encode(seed, data, w, h);
+    for (ii = 0; ii < 4; ii++) {
+        data[_rand(seed) % size] = (uint8_t)_rand(seed);
+    }
+    if (_rand(seed) % 4 == 0) {
+        size -= _rand(seed) % (size < 4 ? size : 4);
+    }
+    num_ref = _ref_decode(data, size, w, h, ref);
+    num     = pg_decode_rle(data, size, img, MAX_ELEM, w, h);
+    if (num_ref == -1 && num >= 0) {
+        fprintf(stderr, "corrupted data: too many pixels not detected\n");
+        return -1;
+    }
+    if (num_ref >= 0 && num >= 0 && (num < num_ref || _compare(img, ref, num_ref) < 0)) {
+        fprintf(stderr, "corrupted data: got %d elements, expected %d\n", num, num_ref);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    uint8_t        *data = malloc(MAX_DATA);
+    BD_PG_RLE_ELEM *ref  = malloc(MAX_ELEM * sizeof(*ref));
+    BD_PG_RLE_ELEM *img  = malloc(MAX_ELEM * sizeof(*img));
+    uint32_t        seed = 1;
+    int             ii, result = 1;
+
+    if (!data || !ref || !img) {
+        goto out;
+    }
+
+    /* corrupted data is tested: do not log errors */
+    bd_set_debug_mask(0);
+
+    for (ii = 0; ii < 20000; ii++) {
+        if (_test(&seed, data, ref, img) < 0) {
+            fprintf(stderr, "image %d failed\n", ii);
+            goto out;
+        }
+    }
+
+    result = 0;
+
+ out:
+    free(data);
+    free(ref);
+    free(img);
+    return result;
+}
@@ -0,0 +1,217 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Positional reads (file_read_at()) must return the same data as
+ * seek + read, must not change file position, and must work when
+ * called from multiple threads at once.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "file/file.h"
+#include "util/thread.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_FILE  "read_at_test.tmp"
+#define FILE_SIZE  (1000 * 6144 + 1234)
+#define MAX_READ   (64 * 1024)
+#define NUM_JOBS   4
+
+static uint8_t data[FILE_SIZE];
+
+static uint32_t _rand(uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+static int _create_file(void)
+{
+    uint32_t seed = 1;
+    unsigned ii;
+    FILE    *f = fopen(TEST_FILE, "wb");
+
+    if (!f) {
+        return -1;
+    }
+    for (ii = 0; ii < FILE_SIZE; ii++) {
+        data[ii] = (uint8_t)_rand(&seed);
+    }
+    if (fwrite(data, 1, FILE_SIZE, f) != FILE_SIZE) {
+        fclose(f);
+        return -1;
+    }
+    return fclose(f) ? -1 : 0;
+}
+
+/* compare to seek + read */
+static int _test_seq(BD_FILE_H *ref, BD_FILE_EXT *fp)
+{
+    static uint8_t buf_ref[MAX_READ], buf[MAX_READ];
+    uint32_t seed = 7;
+    int      ii;
+
+    if (file_seek(&fp->file, 1000, SEEK_SET) != 1000) {
+        fprintf(stderr, "seek failed\n");
+        return -1;
+    }
+
+    for (ii = 0; ii < 5000; ii++) {
+        int64_t offset = _rand(&seed) % (FILE_SIZE + 10000);
+        size_t  size   = 1 + _rand(&seed) % MAX_READ;
+        int64_t got_ref, got;
+
+        if (file_seek(ref, offset, SEEK_SET) != offset) {
+            fprintf(stderr, "seek failed\n");
+            return -1;
+        }
+        got_ref = (int64_t)file_read(ref, buf_ref, size);
+        got     = file_read_at(fp, buf, size, offset);
+        if (got != got_ref) {
+            fprintf(stderr, "read_at(%lld, %zu): got %lld, expected %lld\n",
+                    (long long)offset, size, (long long)got, (long long)got_ref);
+            return -1;
+        }
+        if (got > 0 && memcmp(buf, buf_ref, (size_t)got)) {
+            fprintf(stderr, "read_at(%lld, %zu): data mismatch\n", (long long)offset, size);
+            return -1;
+        }
+        if (fp->read_at && file_tell(&fp->file) != 1000) {
+            fprintf(stderr, "read_at() changed file position\n");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+typedef struct {
+    BD_FILE_EXT *fp;
+    int          failed[NUM_JOBS];
+} JOB;
+
+static void _read_job(void *arg, unsigned idx)
+{
+    JOB     *job  = (JOB *)arg;
+    uint8_t *buf  = malloc(MAX_READ);
+    uint32_t seed = idx + 100;
+    int      ii;
+
+    if (!buf) {
+        job->failed[idx] = 1;
+        return;
+    }
+
+    for (ii = 0; ii < 2000; ii++) {
+        int64_t offset = _rand(&seed) % FILE_SIZE;
+        size_t  size   = 1 + _rand(&seed) % MAX_READ;
+        int64_t expect = offset + (int64_t)size > FILE_SIZE ? FILE_SIZE - offset : (int64_t)size;
+
+        if (file_read_at(job->fp, buf, size, offset) != expect ||
+            memcmp(buf, data + offset, (size_t)expect)) {
+            job->failed[idx] = 1;
+            break;
+        }
+    }
+
+    free(buf);
+}
+
+/* concurrent reads */
+static int _test_threads(BD_FILE_EXT *fp)
+{
+    BD_THREAD_POOL *pool;
+    JOB             job;
+    unsigned        ii;
+
+    if (!fp->read_at) {
+        /* seek + read fallback is not thread-safe */
+        return 0;
+    }
+
+    pool = bd_thread_pool_init();
+    if (!pool) {
+        return -1;
+    }
+    bd_thread_pool_set_threads(pool, NUM_JOBS - 1);
+
+    memset(&job, 0, sizeof(job));
+    job.fp = fp;
+    bd_thread_pool_run(pool, _read_job, &job, NUM_JOBS);
+
+    bd_thread_pool_free(&pool);
+
+    for (ii = 0; ii < NUM_JOBS; ii++) {
+        if (job.failed[ii]) {
+            fprintf(stderr, "concurrent read_at() failed\n");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    BD_FILE_H *ref;
+    int        use_mmap, result = 1;
+
+    if (_create_file() < 0) {
+        fprintf(stderr, "error creating " TEST_FILE "\n");
+        return 1;
+    }
+
+    ref = file_open_default()(TEST_FILE, "rb");
+    if (!ref) {
+        fprintf(stderr, "error opening " TEST_FILE "\n");
+        goto out;
+    }
+
+    for (use_mmap = 0; use_mmap < 2; use_mmap++) {
+        BD_FILE_EXT *fp = file_open_ext(TEST_FILE, use_mmap);
+        int          r;
+
+        if (!fp) {
+            fprintf(stderr, "file_open_ext(%d) failed\n", use_mmap);
+            goto out;
+        }
+        r = _test_seq(ref, fp);
+        if (!r) {
+            r = _test_threads(fp);
+        }
+        file_close(&fp->file);
+        if (r < 0) {
+            fprintf(stderr, "file_open_ext(%d): test failed\n", use_mmap);
+            goto out;
+        }
+    }
+
+    result = 0;
+
+ out:
+    if (ref) file_close(ref);
+    (void)file_unlink(TEST_FILE);
+    return result;
+}
@@ -0,0 +1,167 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Read-ahead stream (readahead_open()) must return the same data as
+ * reading the file directly. Uses random seeks and read sizes, and
+ * two streams served by the same worker.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "disc/readahead.h"
+#include "file/file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_FILE  "readahead_test.tmp"
+#define UNIT       6144
+#define NUM_UNITS  1000
+#define MAX_READ   40
+
+static uint32_t _rand(uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+static int _create_file(void)
+{
+    uint8_t  buf[UNIT];
+    uint32_t seed = 1;
+    unsigned ii, jj;
+    FILE    *f = fopen(TEST_FILE, "wb");
+
+    if (!f) {
+        return -1;
+    }
+    for (ii = 0; ii < NUM_UNITS; ii++) {
+        for (jj = 0; jj < UNIT; jj++) {
+            buf[jj] = (uint8_t)_rand(&seed);
+        }
+        if (fwrite(buf, 1, UNIT, f) != UNIT) {
+            fclose(f);
+            return -1;
+        }
+    }
+    return fclose(f) ? -1 : 0;
+}
+
+/* read same range from both streams and compare */
+static int _compare(BD_FILE_H *ref, BD_FILE_H *ra, int64_t pos, unsigned num_units)
+{
+    static uint8_t buf_ref[MAX_READ * UNIT], buf_ra[MAX_READ * UNIT];
+    int64_t got_ref, got_ra;
+
+    if (file_seek(ref, pos, SEEK_SET) != pos || file_seek(ra, pos, SEEK_SET) != pos) {
+        fprintf(stderr, "seek to %lld failed\n", (long long)pos);
+        return -1;
+    }
+
+    got_ref = ref->read(ref, buf_ref, (int64_t)num_units * UNIT);
+    got_ra  = ra->read(ra, buf_ra, (int64_t)num_units * UNIT);
+
+    if (got_ref != got_ra) {
+        fprintf(stderr, "read at %lld: got %lld bytes, expected %lld\n",
+                (long long)pos, (long long)got_ra, (long long)got_ref);
+        return -1;
+    }
+    if (got_ref > 0 && memcmp(buf_ref, buf_ra, (size_t)got_ref)) {
+        fprintf(stderr, "read at %lld: data mismatch\n", (long long)pos);
+        return -1;
+    }
+    if (file_tell(ref) != file_tell(ra)) {
+        fprintf(stderr, "read at %lld: position mismatch\n", (long long)pos);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    BD_READAHEAD *ra;
+    BD_FILE_H    *ref, *ra1, *ra2;
+    uint32_t      seed = 7;
+    int64_t       pos1 = 10 * UNIT, pos2 = 0;
+    int           ii, result = 1;
+
+    ra = readahead_init(64);
+    if (!ra) {
+        fprintf(stderr, "read-ahead not supported\n");
+        return 77;
+    }
+
+    if (_create_file() < 0) {
+        fprintf(stderr, "error creating " TEST_FILE "\n");
+        readahead_free(&ra);
+        return 1;
+    }
+
+    ref = file_open(TEST_FILE, "rb");
+    ra1 = readahead_open(ra, file_open(TEST_FILE, "rb"), 10 * UNIT, 500 * UNIT);
+    ra2 = readahead_open(ra, file_open(TEST_FILE, "rb"), 0, 100 * UNIT);
+    if (!ref || !ra1 || !ra2) {
+        fprintf(stderr, "error opening " TEST_FILE "\n");
+        goto out;
+    }
+
+    if (file_size(ra1) != file_size(ref)) {
+        fprintf(stderr, "file size mismatch\n");
+        goto out;
+    }
+
+    for (ii = 0; ii < 3000; ii++) {
+        unsigned n = 1 + _rand(&seed) % MAX_READ;
+
+        /* mostly sequential reads, with some random seeks (also past end limit and EOF) */
+        if (_rand(&seed) % 50 == 0) {
+            pos1 = (int64_t)(_rand(&seed) % (NUM_UNITS + 10)) * UNIT;
+        }
+        if (_compare(ref, ra1, pos1, n) < 0) {
+            goto out;
+        }
+        pos1 = file_tell(ref);
+        if (pos1 >= (int64_t)NUM_UNITS * UNIT) {
+            pos1 = 0;
+        }
+
+        /* second stream is buffered after first one has reached its end limit */
+        if (ii % 10 == 0) {
+            if (_compare(ref, ra2, pos2, n) < 0) {
+                goto out;
+            }
+            pos2 = file_tell(ref) % ((int64_t)NUM_UNITS * UNIT);
+        }
+    }
+
+    result = 0;
+
+ out:
+    if (ra2) file_close(ra2);
+    if (ra1) file_close(ra1);
+    if (ref) file_close(ref);
+    readahead_free(&ra);
+    (void)file_unlink(TEST_FILE);
+    return result;
+}
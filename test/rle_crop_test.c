@@ -0,0 +1,230 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+
+/*
+ * Cropping RLE image with line index (rle_line_index()) must produce the
+ * same image as cropping without index and cropping decoded pixels.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "decoders/rle.h"
+#include "util/log_control.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_W  2000
+#define MAX_H  64
+
+static unsigned num_log;
+
+static void _log(const char *msg)
+{
+    (void)msg;
+    num_log++;
+}
+
+static uint32_t _rand(uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+/* encode random image. Returns number of elements. */
+static unsigned _encode(uint32_t *seed, BD_PG_RLE_ELEM *img, uint16_t *pix, int w, int h)
+{
+    unsigned n = 0;
+    int      x, y;
+
+    for (y = 0; y < h; y++) {
+        for (x = 0; x < w; ) {
+            unsigned r     = _rand(seed) % 8;
+            int      len   = 1 + _rand(seed) % (r < 5 ? 4 : r < 7 ? 64 : 2000);
+            uint16_t color = _rand(seed) % 4 ? _rand(seed) & 0xff : 0;
+            int      i;
+
+            if (len > w - x) {
+                len = w - x;
+            }
+            img[n].len   = len;
+            img[n].color = color;
+            n++;
+            for (i = 0; i < len; i++) {
+                pix[y * w + x + i] = color;
+            }
+            x += len;
+        }
+        img[n].len   = 0;
+        img[n].color = 0;
+        n++;
+    }
+
+    return n;
+}
+
+/* check cropped image against pixels */
+static int _check(const BD_PG_RLE_ELEM *img, const uint16_t *pix, int w,
+                  int crop_x, int crop_y, int crop_w, int crop_h)
+{
+    int x, y;
+
+    for (y = 0; y < crop_h; y++) {
+        const uint16_t *line = pix + (crop_y + y) * w + crop_x;
+        for (x = 0; x < crop_w; img++) {
+            int i;
+            if (img->len < 1 || x + img->len > crop_w) {
+                fprintf(stderr, "invalid element at %d,%d (len %d)\n", x, y, img->len);
+                return -1;
+            }
+            for (i = 0; i < img->len; i++, x++) {
+                if (img->color != line[x]) {
+                    fprintf(stderr, "pixel mismatch at %d,%d\n", x, y);
+                    return -1;
+                }
+            }
+        }
+        if (img->len) {
+            fprintf(stderr, "missing eol at line %d\n", y);
+            return -1;
+        }
+        img++;
+    }
+
+    return 0;
+}
+
+/* compare encoded images */
+static int _compare(const BD_PG_RLE_ELEM *a, const BD_PG_RLE_ELEM *b, int h)
+{
+    int y = 0;
+
+    while (y < h) {
+        if (a->len != b->len || a->color != b->color) {
+            fprintf(stderr, "element mismatch at line %d\n", y);
+            return -1;
+        }
+        if (!a->len) {
+            y++;
+        }
+        a++;
+        b++;
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    BD_PG_RLE_ELEM *img = malloc(sizeof(*img) * (MAX_W * MAX_H + MAX_H));
+    uint16_t       *pix = malloc(sizeof(*pix) * MAX_W * MAX_H);
+    uint32_t        seed = 1;
+    unsigned        it;
+    int             result = 1;
+
+    if (!img || !pix) {
+        fprintf(stderr, "out of memory\n");
+        goto out;
+    }
+
+    /* any debug message (ex. "eol marker in middle of line") is an error */
+    bd_set_debug_handler(_log);
+    bd_set_debug_mask(DBG_GC | DBG_CRIT);
+
+    for (it = 0; it < 3000; it++) {
+        int       w = 1 + _rand(&seed) % (it % 8 ? 200 : MAX_W);
+        int       h = 1 + _rand(&seed) % MAX_H;
+        unsigned  n = _encode(&seed, img, pix, w, h);
+        uint32_t *idx = rle_line_index(img, w, h);
+        unsigned  c, y;
+
+        if (!idx) {
+            fprintf(stderr, "rle_line_index() failed\n");
+            goto out;
+        }
+
+        /* line index */
+        for (y = 0, c = 0; y < (unsigned)h; y++) {
+            if (idx[y] != c || idx[y] >= n) {
+                fprintf(stderr, "wrong line index %u at line %u\n", idx[y], y);
+                free(idx);
+                goto out;
+            }
+            while (img[c].len) {
+                c++;
+            }
+            c++;
+        }
+
+        /* several crops of same image (scrolling, wipes) */
+        for (c = 0; c < 8; c++) {
+            int crop_x = _rand(&seed) % w;
+            int crop_y = _rand(&seed) % h;
+            int crop_w = 1 + _rand(&seed) % (w - crop_x);
+            int crop_h = 1 + _rand(&seed) % (h - crop_y);
+            BD_PG_RLE_ELEM *a, *b;
+            int r;
+
+            /* full width / height */
+            if (c == 0) {
+                crop_x = crop_y = 0;
+                crop_w = w;
+                crop_h = h;
+            }
+
+            a = rle_crop_object(img, w, crop_x, crop_y, crop_w, crop_h, NULL);
+            b = rle_crop_object(img, w, crop_x, crop_y, crop_w, crop_h, idx);
+            if (!a || !b) {
+                fprintf(stderr, "rle_crop_object() failed\n");
+                bd_refcnt_dec(a);
+                bd_refcnt_dec(b);
+                free(idx);
+                goto out;
+            }
+
+            r = _check(a, pix, w, crop_x, crop_y, crop_w, crop_h);
+            if (!r) {
+                r = _compare(a, b, crop_h);
+            }
+            bd_refcnt_dec(a);
+            bd_refcnt_dec(b);
+
+            if (r < 0 || num_log) {
+                fprintf(stderr, "image %dx%d crop %d,%d %dx%d%s\n", w, h,
+                        crop_x, crop_y, crop_w, crop_h, num_log ? ": debug message" : "");
+                free(idx);
+                goto out;
+            }
+        }
+
+        free(idx);
+    }
+
+    result = 0;
+
+ out:
+    free(img);
+    free(pix);
+    return result;
+}
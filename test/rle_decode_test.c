@@ -0,0 +1,262 @@
+/*
+ * This file is part of libbluray
+ * Copyright (C) 2026  VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * bd_rle_decode_argb() / bd_rle_decode_yuva() must match expanding
+ * RLE image pixel by pixel and converting each pixel separately.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "decoders/overlay.h"
+#include "util/log_control.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_W   400
+#define MAX_H   40
+#define GUARD   0x5a5a5a5a
+#define NO_PIX  0x100      /* missing pixel in short line */
+
+static uint32_t _rand(uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+/* create random image. Some lines are short or too long. */
+static BD_PG_RLE_ELEM *_create_image(uint32_t *seed, int w, int h, uint16_t *pix)
+{
+    BD_PG_RLE_ELEM *img = malloc(sizeof(*img) * (size_t)(2 * MAX_W + 1) * h);
+    int n = 0, x, y;
+
+    if (!img) {
+        return NULL;
+    }
+
+    for (y = 0; y < h; y++) {
+        unsigned mode = _rand(seed) % 8;
+        int      line_w = mode == 0 ? (int)(_rand(seed) % w) : mode == 1 ? w + (int)(_rand(seed) % 50) : w;
+
+        for (x = 0; x < w; x++) {
+            pix[y * w + x] = NO_PIX;
+        }
+        for (x = 0; x < line_w; ) {
+            int len   = 1 + (int)(_rand(seed) % (_rand(seed) % 3 ? 5 : 80));
+            int color = _rand(seed) % 4 ? (int)(_rand(seed) & 0xff) : 0xff;
+            int ii;
+
+            len = len < line_w - x ? len : line_w - x;
+            for (ii = x; ii < x + len && ii < w; ii++) {
+                pix[y * w + ii] = (uint16_t)color;
+            }
+            img[n].len   = (uint16_t)len;
+            img[n].color = (uint16_t)color;
+            n++;
+            x += len;
+        }
+        img[n].len   = 0;
+        img[n].color = 0;
+        n++;
+    }
+
+    return img;
+}
+
+static uint8_t _round_u8(double v)
+{
+    return v <= 0 ? 0 : v >= 255 ? 255 : (uint8_t)(v + 0.5);
+}
+
+/* limited range YCbCr -> full range RGB */
+static uint32_t _ref_argb(const BD_PG_PALETTE_ENTRY *e, unsigned flags)
+{
+    const int    bt709 = !!(flags & BD_RLE_DECODE_BT709);
+    const double kr = bt709 ? 0.2126 : 0.299;
+    const double kb = bt709 ? 0.0722 : 0.114;
+    const double kg = 1.0 - kr - kb;
+    double y  = (e->Y  - 16)  * 255.0 / 219.0;
+    double cb = (e->Cb - 128) * 255.0 / 224.0;
+    double cr = (e->Cr - 128) * 255.0 / 224.0;
+    double r  = y + 2.0 * (1.0 - kr) * cr;
+    double b  = y + 2.0 * (1.0 - kb) * cb;
+    double g  = (y - kr * r - kb * b) / kg;
+    uint8_t a = e->T;
+
+    if (!a) {
+        return 0;
+    }
+    r = _round_u8(r);
+    g = _round_u8(g);
+    b = _round_u8(b);
+    if (flags & BD_RLE_DECODE_PREMULTIPLIED) {
+        r = _round_u8(r * a / 255.0);
+        g = _round_u8(g * a / 255.0);
+        b = _round_u8(b * a / 255.0);
+    }
+    return ((uint32_t)a << 24) | ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+}
+
+static uint32_t _ref_yuva(const BD_PG_PALETTE_ENTRY *e)
+{
+    return ((uint32_t)e->T << 24) | ((uint32_t)e->Y << 16) | ((uint32_t)e->Cb << 8) | e->Cr;
+}
+
+/* allow rounding differences in fixed point conversion */
+static int _argb_close(uint32_t a, uint32_t b)
+{
+    int shift;
+
+    for (shift = 0; shift < 32; shift += 8) {
+        int d = (int)((a >> shift) & 0xff) - (int)((b >> shift) & 0xff);
+        if (d < -1 || d > 1) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int _check(const uint32_t *out, unsigned stride, const uint16_t *pix, int w,
+                  unsigned cx, unsigned cy, unsigned cw, unsigned ch,
+                  const BD_PG_PALETTE_ENTRY *pal, int argb, unsigned flags)
+{
+    unsigned x, y;
+
+    for (y = 0; y < ch; y++) {
+        for (x = 0; x < stride; x++) {
+            uint32_t v = out[y * stride + x];
+            uint16_t p;
+
+            if (x >= cw) {
+                if (v != GUARD) {
+                    fprintf(stderr, "write outside of crop region at %u,%u\n", x, y);
+                    return -1;
+                }
+                continue;
+            }
+
+            p = pix[(y + cy) * w + x + cx];
+            if (p == NO_PIX) {
+                if (v != 0) {
+                    fprintf(stderr, "missing pixel %u,%u not cleared\n", x, y);
+                    return -1;
+                }
+            } else if (argb ? !_argb_close(v, _ref_argb(&pal[p], flags)) : v != _ref_yuva(&pal[p])) {
+                fprintf(stderr, "pixel %u,%u: got %08x, expected %08x\n", x, y, v,
+                        argb ? _ref_argb(&pal[p], flags) : _ref_yuva(&pal[p]));
+                return -1;
+            }
+        }
+    }
+    if (out[ch * stride] != GUARD) {
+        fprintf(stderr, "write after end of buffer\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    static uint16_t     pix[MAX_W * MAX_H];
+    static uint32_t     out[(MAX_W + 5) * MAX_H + 1];
+    BD_PG_PALETTE_ENTRY pal[256];
+    uint32_t            seed = 1;
+    unsigned            ii, jj;
+
+    /* invalid arguments are tested: do not log errors */
+    bd_set_debug_mask(0);
+
+    for (ii = 0; ii < 3000; ii++) {
+        BD_PG_RLE_ELEM *img;
+        BD_OVERLAY      ov;
+        int             w = 1 + (int)(_rand(&seed) % MAX_W);
+        int             h = 1 + (int)(_rand(&seed) % MAX_H);
+        unsigned        cx, cy, cw, ch, stride, flags;
+        int             r = -1;
+
+        for (jj = 0; jj < 256; jj++) {
+            pal[jj].Y  = (uint8_t)(16 + _rand(&seed) % 220);
+            pal[jj].Cr = (uint8_t)(16 + _rand(&seed) % 225);
+            pal[jj].Cb = (uint8_t)(16 + _rand(&seed) % 225);
+            pal[jj].T  = jj == 0xff ? 0 : (uint8_t)_rand(&seed);
+        }
+
+        img = _create_image(&seed, w, h, pix);
+        if (!img) {
+            return 1;
+        }
+
+        memset(&ov, 0, sizeof(ov));
+        ov.w       = (uint16_t)w;
+        ov.h       = (uint16_t)h;
+        ov.img     = img;
+        ov.palette = pal;
+
+        cx     = _rand(&seed) % w;
+        cy     = _rand(&seed) % h;
+        cw     = 1 + _rand(&seed) % (w - cx);
+        ch     = 1 + _rand(&seed) % (h - cy);
+        stride = cw + _rand(&seed) % 5;
+        flags  = _rand(&seed) % 4;
+
+        for (jj = 0; jj < stride * ch + 1; jj++) {
+            out[jj] = GUARD;
+        }
+        if (bd_rle_decode_argb(&ov, out, stride, cx, cy, cw, ch, flags) < 0 ||
+            _check(out, stride, pix, w, cx, cy, cw, ch, pal, 1, flags) < 0) {
+            fprintf(stderr, "bd_rle_decode_argb() failed (image %u)\n", ii);
+            goto next;
+        }
+
+        for (jj = 0; jj < stride * ch + 1; jj++) {
+            out[jj] = GUARD;
+        }
+        if (bd_rle_decode_yuva(&ov, out, stride, cx, cy, cw, ch) < 0 ||
+            _check(out, stride, pix, w, cx, cy, cw, ch, pal, 0, 0) < 0) {
+            fprintf(stderr, "bd_rle_decode_yuva() failed (image %u)\n", ii);
+            goto next;
+        }
+
+        /* invalid crop rectangles */
+        if (bd_rle_decode_argb(&ov, out, stride, cx, cy, w - cx + 1, ch, 0) != -1 ||
+            bd_rle_decode_argb(&ov, out, stride, cx, cy, cw, h - cy + 1, 0) != -1 ||
+            bd_rle_decode_argb(&ov, out, stride, cx + 1, cy, (unsigned)-1, ch, 0) != -1 ||
+            bd_rle_decode_yuva(&ov, out, stride, cx, cy + 1, cw, (unsigned)-1) != -1 ||
+            bd_rle_decode_yuva(&ov, out, cw - 1, cx, cy, cw, ch) != -1) {
+            fprintf(stderr, "invalid crop rectangle accepted (image %u)\n", ii);
+            goto next;
+        }
+
+        r = 0;
+
+     next:
+        free(img);
+        if (r < 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}